@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_boot, LOG_LEVEL_DBG);
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+#include "app_boot.h"
+
+/* Indexed by enum app_boot_event; also the keys of the RPC response */
+static const char *const event_names[APP_BOOT_EVENT_COUNT] = {
+	[APP_BOOT_MAIN] = "main",
+	[APP_BOOT_SENSORS] = "sensors",
+	[APP_BOOT_FIRST_SAMPLE] = "first_sample",
+	[APP_BOOT_DISPLAY] = "display",
+	[APP_BOOT_NETWORK] = "network",
+	[APP_BOOT_CONNECTED] = "connected",
+	[APP_BOOT_FIRST_UPLOAD] = "first_upload",
+};
+
+static struct k_spinlock boot_lock;
+static int64_t timeline_ms[APP_BOOT_EVENT_COUNT];
+static uint32_t recorded;
+
+void app_boot_mark(enum app_boot_event event)
+{
+	k_spinlock_key_t key = k_spin_lock(&boot_lock);
+	int64_t now_ms;
+
+	if (recorded & BIT(event)) {
+		k_spin_unlock(&boot_lock, key);
+		return;
+	}
+
+	now_ms = k_uptime_get();
+	timeline_ms[event] = now_ms;
+	recorded |= BIT(event);
+
+	k_spin_unlock(&boot_lock, key);
+
+	LOG_INF("Boot: %s at %lld ms", event_names[event], now_ms);
+}
+
+bool app_boot_add_to_map(zcbor_state_t *map)
+{
+	int64_t snapshot_ms[APP_BOOT_EVENT_COUNT];
+	k_spinlock_key_t key;
+	uint32_t snapshot;
+	bool ok = true;
+
+	key = k_spin_lock(&boot_lock);
+	memcpy(snapshot_ms, timeline_ms, sizeof(snapshot_ms));
+	snapshot = recorded;
+	k_spin_unlock(&boot_lock, key);
+
+	for (int i = 0; ok && (i < APP_BOOT_EVENT_COUNT); i++) {
+		if (!(snapshot & BIT(i))) {
+			continue;
+		}
+
+		ok = zcbor_tstr_encode_ptr(map, event_names[i], strlen(event_names[i])) &&
+		     zcbor_int64_put(map, snapshot_ms[i]);
+	}
+
+	return ok;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Boot timeline.
+ *
+ * Sampling starts as soon as the sensors are initialized, while the faceplate
+ * and the network come up in parallel, so the order in which they finish
+ * varies from boot to boot. Each milestone is recorded here with its uptime
+ * the first time it is reached, logged, and returned by the
+ * `get_boot_timeline` RPC (see app_rpc.h) to compare time-to-first-sample and
+ * time-to-first-upload across firmware releases.
+ */
+
+#ifndef __APP_BOOT_H__
+#define __APP_BOOT_H__
+
+#include <zcbor_encode.h>
+
+enum app_boot_event {
+	/* main() entered */
+	APP_BOOT_MAIN,
+	/* Sensors, sample store and time base initialized */
+	APP_BOOT_SENSORS,
+	/* First sample taken */
+	APP_BOOT_FIRST_SAMPLE,
+	/* Ostentus faceplate set up */
+	APP_BOOT_DISPLAY,
+	/* LTE registered, or WiFi/DHCP up */
+	APP_BOOT_NETWORK,
+	/* Golioth client connected */
+	APP_BOOT_CONNECTED,
+	/* First LightDB Stream upload acknowledged */
+	APP_BOOT_FIRST_UPLOAD,
+	APP_BOOT_EVENT_COUNT
+};
+
+/** Record the uptime of `event`; only its first occurrence is kept */
+void app_boot_mark(enum app_boot_event event);
+
+/** Add every recorded event and its uptime in ms to an open zcbor map */
+bool app_boot_add_to_map(zcbor_state_t *map);
+
+#endif /* __APP_BOOT_H__ */
@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_burst, LOG_LEVEL_DBG);
+
+#include <stdio.h>
+#include <string.h>
+#include <golioth/client.h>
+#include <golioth/stream.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zcbor_encode.h>
+
+#include "app_burst.h"
+#include "app_burst_codec.h"
+#include "app_imu.h"
+#include "app_moisture.h"
+#include "app_sensors.h"
+#include "app_time.h"
+
+#if APP_HAS_IMU && defined(CONFIG_APP_IMU_FIFO)
+#define BURST_HAS_IMU 1
+#else
+#define BURST_HAS_IMU 0
+#endif
+
+/* Channels of a frame, in order */
+#define BURST_CHANNELS(X)                                                                          \
+	IF_ENABLED(APP_HAS_MOISTURE, (X(MOISTURE_RAW)))                                            \
+	IF_ENABLED(BURST_HAS_IMU, (X(ACCEL_X) X(ACCEL_Y) X(ACCEL_Z)))
+
+#define BURST_CH(_id) APP_CH_##_id,
+
+static const enum app_channel burst_chans[] = {BURST_CHANNELS(BURST_CH)};
+
+#define BURST_CH_COUNT ARRAY_SIZE(burst_chans)
+
+BUILD_ASSERT(BURST_CH_COUNT > 0, "Burst capture needs the moisture probe or the LIS2DH FIFO");
+
+#define BURST_FRAME_MAX_LEN (APP_BURST_VARINT_MAX_LEN * BURST_CH_COUNT)
+
+/* Longest document without its data: keys, numbers and "group/key" names */
+#define BURST_HEADER_MAX_LEN (80 + 24 * BURST_CH_COUNT)
+
+/*
+ * A document is sent as a single CoAP message, so it must fit in the
+ * client's packet buffer, which is sized for the largest upload block.
+ * Captures larger than that are sent as several parts.
+ */
+#define BURST_DOC_MAX_LEN CONFIG_GOLIOTH_BLOCKWISE_UPLOAD_MAX_BLOCK_SIZE
+#define BURST_PART_DATA_LEN (BURST_DOC_MAX_LEN - BURST_HEADER_MAX_LEN)
+
+BUILD_ASSERT(BURST_PART_DATA_LEN >= 64, "Upload block too small for a burst document");
+
+/* Longest wait for Golioth to acknowledge a part */
+#define BURST_PART_TIMEOUT_S 60
+
+/* Nesting depth of a document: map -> channel list */
+#define CBOR_BURST_DEPTH 2
+
+enum burst_state {
+	BURST_IDLE,
+	BURST_CAPTURE,
+	BURST_UPLOAD,
+};
+
+static struct golioth_client *client;
+
+static atomic_t state = ATOMIC_INIT(BURST_IDLE);
+static atomic_t requested_s;
+static K_SEM_DEFINE(start_sem, 0, 1);
+
+/* Compressed frames, then the document of each part; only used by the burst thread */
+static uint8_t burst_data[CONFIG_APP_BURST_DATA_LEN];
+static uint8_t burst_doc[BURST_DOC_MAX_LEN];
+
+/* Outcome of the upload of the last part */
+static K_SEM_DEFINE(part_sem, 0, 1);
+static enum golioth_status part_status;
+
+#if APP_HAS_MOISTURE
+static const struct device *moisture_dev = DEVICE_DT_GET(APP_MOISTURE_NODE);
+
+/* One conversion, independently of the loop's oversampled reads */
+static int moisture_read(int32_t *val)
+{
+	uint8_t wr = 0x00;
+	uint8_t rd[2];
+	int err;
+
+	err = i2c_write_read(moisture_dev, MCP3221_I2C_ADDR, &wr, sizeof(wr), rd, sizeof(rd));
+	if (err) {
+		return err;
+	}
+
+	*val = ((rd[0] << 8) + rd[1]) & MOISTURE_ADC_MAX;
+
+	return 0;
+}
+#endif
+
+/* Read one frame; a value that could not be read repeats the previous one */
+static void frame_read(int32_t frame[BURST_CH_COUNT])
+{
+	size_t ch = 0;
+	int err;
+
+#if APP_HAS_MOISTURE
+	err = moisture_read(&frame[ch]);
+	if (err) {
+		LOG_DBG("Moisture read failed: %d", err);
+	}
+	ch++;
+#endif
+
+#if BURST_HAS_IMU
+	err = app_imu_fifo_sample(&frame[ch]);
+	if ((err < 0) && (err != -ENODATA)) {
+		LOG_DBG("IMU read failed: %d", err);
+	}
+	ch += 3;
+#endif
+}
+
+/* Capture frames into burst_data; return the number of frames */
+static uint32_t capture(uint32_t duration_s, int64_t *start_ms, size_t *data_len)
+{
+	uint32_t max_frames = duration_s * CONFIG_APP_BURST_RATE_HZ;
+	/* The first frame is stored as the difference from 0 */
+	int32_t frame[BURST_CH_COUNT] = {0};
+	int32_t prev[BURST_CH_COUNT] = {0};
+	uint32_t late = 0;
+	size_t len = 0;
+	uint32_t n;
+	int64_t start;
+
+	IF_ENABLED(BURST_HAS_IMU, (app_imu_odr_set(CONFIG_APP_BURST_IMU_ODR_HZ);));
+
+	start = k_uptime_ticks();
+	*start_ms = k_ticks_to_ms_floor64(start);
+
+	for (n = 0; n < max_frames; n++) {
+		/* From the start of the burst, so rounding does not add up */
+		int64_t due = start + k_us_to_ticks_near64((uint64_t)n * USEC_PER_SEC /
+							   CONFIG_APP_BURST_RATE_HZ);
+
+		if (k_uptime_ticks() > due) {
+			late++;
+		}
+		k_sleep(K_TIMEOUT_ABS_TICKS(due));
+
+		if (sizeof(burst_data) - len < BURST_FRAME_MAX_LEN) {
+			LOG_WRN("Burst buffer full after %u frames", n);
+			break;
+		}
+
+		frame_read(frame);
+		len += app_burst_frame_encode(&burst_data[len], frame, prev, BURST_CH_COUNT);
+		memcpy(prev, frame, sizeof(frame));
+	}
+
+	IF_ENABLED(BURST_HAS_IMU, (app_imu_odr_set(CONFIG_APP_IMU_ODR_HZ);));
+
+	if (late) {
+		LOG_WRN("%u of %u burst frames were late", late, n);
+	}
+
+	*data_len = len;
+
+	return n;
+}
+
+static int encode_burst(uint8_t *buf, size_t buf_len, int64_t ts_ms, uint32_t frames,
+			size_t part, size_t parts, const uint8_t *data, size_t data_len)
+{
+	ZCBOR_STATE_E(zse, CBOR_BURST_DEPTH, buf, buf_len, 1);
+	char name[24];
+	bool ok;
+
+	ok = zcbor_map_start_encode(zse, 7);
+
+	if (ok && ts_ms) {
+		ok = zcbor_tstr_put_lit(zse, "ts") && zcbor_int64_put(zse, ts_ms);
+	}
+
+	ok = ok && zcbor_tstr_put_lit(zse, "rate_hz") &&
+	     zcbor_uint32_put(zse, CONFIG_APP_BURST_RATE_HZ) && zcbor_tstr_put_lit(zse, "n") &&
+	     zcbor_uint32_put(zse, frames) && zcbor_tstr_put_lit(zse, "part") &&
+	     zcbor_uint32_put(zse, part) && zcbor_tstr_put_lit(zse, "parts") &&
+	     zcbor_uint32_put(zse, parts) && zcbor_tstr_put_lit(zse, "channels") &&
+	     zcbor_list_start_encode(zse, BURST_CH_COUNT);
+
+	for (size_t ch = 0; ok && ch < BURST_CH_COUNT; ch++) {
+		const struct app_channel_info *info = &app_channels[burst_chans[ch]];
+		int len = snprintf(name, sizeof(name), "%s/%s", info->group, info->key);
+
+		ok = zcbor_tstr_encode_ptr(zse, name, MIN(len, sizeof(name) - 1));
+	}
+
+	ok = ok && zcbor_list_end_encode(zse, BURST_CH_COUNT) && zcbor_tstr_put_lit(zse, "data") &&
+	     zcbor_bstr_encode_ptr(zse, data, data_len) && zcbor_map_end_encode(zse, 7);
+	if (!ok) {
+		return -ENOMEM;
+	}
+
+	return zse->payload - buf;
+}
+
+/* Callback for LightDB Stream */
+static void part_handler(struct golioth_client *client, enum golioth_status status,
+			 const struct golioth_coap_rsp_code *coap_rsp_code, const char *path,
+			 void *arg)
+{
+	part_status = status;
+	k_sem_give(&part_sem);
+}
+
+/* Upload `burst_data` as documents of at most BURST_PART_DATA_LEN bytes of data */
+static void upload(int64_t start_ms, uint32_t frames, size_t data_len)
+{
+	size_t parts = app_burst_part_count(data_len, BURST_PART_DATA_LEN);
+	int64_t ts_ms = 0;
+	int err;
+	int len;
+
+	if (!golioth_client_is_connected(client)) {
+		LOG_WRN("Not connected, dropping burst");
+		return;
+	}
+
+	app_time_to_unix_ms(start_ms, &ts_ms);
+
+	for (size_t part = 0; part < parts; part++) {
+		len = encode_burst(burst_doc, sizeof(burst_doc), ts_ms, frames, part, parts,
+				   &burst_data[part * BURST_PART_DATA_LEN],
+				   app_burst_part_len(data_len, BURST_PART_DATA_LEN, part));
+		if (len < 0) {
+			LOG_ERR("Failed to encode burst: %d", len);
+			return;
+		}
+
+		/* One part at a time, so a capture never floods the request queue */
+		k_sem_reset(&part_sem);
+
+		err = golioth_stream_set_async(client,
+					       "burst",
+					       GOLIOTH_CONTENT_TYPE_CBOR,
+					       burst_doc,
+					       len,
+					       part_handler,
+					       NULL);
+		if (err) {
+			LOG_ERR("Failed to send burst to Golioth: %d", err);
+			return;
+		}
+
+		if (k_sem_take(&part_sem, K_SECONDS(BURST_PART_TIMEOUT_S))) {
+			LOG_ERR("Burst upload timed out");
+			return;
+		}
+
+		if (part_status != GOLIOTH_OK) {
+			LOG_ERR("Burst upload failed: %d", part_status);
+			return;
+		}
+	}
+
+	LOG_INF("Sent burst of %u frames in %zu parts (%zu bytes, %zu raw)", frames, parts,
+		data_len, frames * BURST_CH_COUNT * sizeof(int32_t));
+}
+
+static void burst_thread(void *p1, void *p2, void *p3)
+{
+	while (true) {
+		uint32_t duration_s;
+		uint32_t frames;
+		int64_t start_ms;
+		size_t data_len;
+
+		k_sem_take(&start_sem, K_FOREVER);
+
+		duration_s = atomic_get(&requested_s);
+		LOG_INF("Capturing %u s burst at %d Hz", duration_s, CONFIG_APP_BURST_RATE_HZ);
+
+		frames = capture(duration_s, &start_ms, &data_len);
+
+		atomic_set(&state, BURST_UPLOAD);
+		upload(start_ms, frames, data_len);
+		atomic_set(&state, BURST_IDLE);
+	}
+}
+
+K_THREAD_DEFINE(burst_tid, CONFIG_APP_BURST_STACK_SIZE, burst_thread, NULL, NULL, NULL,
+		CONFIG_APP_BURST_PRIORITY, 0, 0);
+
+void app_burst_set_client(struct golioth_client *burst_client)
+{
+	client = burst_client;
+}
+
+int app_burst_start(uint32_t duration_s)
+{
+	if ((duration_s == 0) || (duration_s > CONFIG_APP_BURST_DURATION_MAX_S)) {
+		return -EINVAL;
+	}
+
+	if (!atomic_cas(&state, BURST_IDLE, BURST_CAPTURE)) {
+		return -EBUSY;
+	}
+
+	atomic_set(&requested_s, duration_s);
+	k_sem_give(&start_sem);
+
+	return 0;
+}
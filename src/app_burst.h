@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * High-rate burst capture, for installing and diagnosing probes.
+ *
+ * A burst samples the moisture ADC and the accelerometer every
+ * 1 / `CONFIG_APP_BURST_RATE_HZ` seconds for a few seconds, then uploads the
+ * capture to the `burst` path of LightDB Stream. It is started by the
+ * `capture_burst` RPC (see app_rpc.h) or, with `CONFIG_APP_BURST_BUTTON`, by
+ * the user button.
+ *
+ * The capture runs in its own thread, below the priority of the sensor loop,
+ * so the regular readings keep their schedule. Each frame holds one MCP3221
+ * conversion and the mean of the LIS2DH samples collected since the previous
+ * frame; the accelerometer runs at `CONFIG_APP_BURST_IMU_ODR_HZ` for the
+ * duration of the burst, and the samples read by the burst still count
+ * towards the next regular reading (see app_imu.h).
+ *
+ * Frames are compressed as they are captured into a static buffer: each value
+ * is stored as the zigzag varint of its difference from the previous frame,
+ * which takes one or two bytes for slowly changing signals. The capture ends
+ * early when the buffer cannot hold another frame. Nothing is allocated.
+ *
+ * Each document must fit in a single CoAP message, so a capture larger than
+ * one upload block is sent as several documents, one after the other.
+ */
+
+#ifndef __APP_BURST_H__
+#define __APP_BURST_H__
+
+#include <errno.h>
+#include <stdint.h>
+#include <golioth/client.h>
+
+#ifdef CONFIG_APP_BURST
+
+void app_burst_set_client(struct golioth_client *burst_client);
+
+/**
+ * Start a burst; may be called from an ISR.
+ *
+ * @param duration_s Capture length, up to `CONFIG_APP_BURST_DURATION_MAX_S`
+ *
+ * @return 0, -EINVAL for a duration out of range, or -EBUSY while a burst is
+ * being captured or uploaded
+ */
+int app_burst_start(uint32_t duration_s);
+
+#else
+
+static inline void app_burst_set_client(struct golioth_client *burst_client)
+{
+}
+
+static inline int app_burst_start(uint32_t duration_s)
+{
+	return -ENOTSUP;
+}
+
+#endif /* CONFIG_APP_BURST */
+
+#endif /* __APP_BURST_H__ */
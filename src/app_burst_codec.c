@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/sys/util.h>
+
+#include "app_burst_codec.h"
+
+/* Zigzag of the two's complement bits of a delta */
+static uint32_t zigzag_bits(uint32_t bits)
+{
+	/* The sign bit spread over the word, without shifting a negative value */
+	return (bits << 1) ^ (0U - (bits >> 31));
+}
+
+uint32_t app_burst_zigzag(int32_t delta)
+{
+	return zigzag_bits((uint32_t)delta);
+}
+
+size_t app_burst_varint_put(uint8_t *buf, uint32_t value)
+{
+	size_t len = 0;
+
+	while (value >= 0x80) {
+		buf[len++] = (value & 0x7f) | 0x80;
+		value >>= 7;
+	}
+	buf[len++] = value;
+
+	return len;
+}
+
+size_t app_burst_frame_encode(uint8_t *buf, const int32_t *frame, const int32_t *prev,
+			      size_t count)
+{
+	size_t len = 0;
+
+	for (size_t ch = 0; ch < count; ch++) {
+		/* Wraps instead of overflowing; the decoder adds modulo 2^32 */
+		uint32_t delta = (uint32_t)frame[ch] - (uint32_t)prev[ch];
+
+		len += app_burst_varint_put(&buf[len], zigzag_bits(delta));
+	}
+
+	return len;
+}
+
+size_t app_burst_part_count(size_t data_len, size_t part_len)
+{
+	return MAX(DIV_ROUND_UP(data_len, part_len), 1);
+}
+
+size_t app_burst_part_len(size_t data_len, size_t part_len, size_t part)
+{
+	size_t offset = part * part_len;
+
+	return (offset < data_len) ? MIN(data_len - offset, part_len) : 0;
+}
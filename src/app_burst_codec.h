@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Encoding of burst captures (see app_burst.h), apart from the capture thread
+ * so that it can be tested on its own.
+ *
+ * Each value of a frame is stored as its difference from the same channel in
+ * the previous frame, taken modulo 2^32, zigzag encoded and written as a
+ * little-endian base-128 varint.
+ */
+
+#ifndef __APP_BURST_CODEC_H__
+#define __APP_BURST_CODEC_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* A 32-bit varint takes at most 5 bytes */
+#define APP_BURST_VARINT_MAX_LEN 5
+
+/** Map 0, -1, 1, -2... to 0, 1, 2, 3... so that small deltas of either sign stay small */
+uint32_t app_burst_zigzag(int32_t delta);
+
+/** Write `value` as a varint; return its length */
+size_t app_burst_varint_put(uint8_t *buf, uint32_t value);
+
+/**
+ * Append the difference of each of the `count` values of `frame` from `prev`.
+ * `buf` must hold `count * APP_BURST_VARINT_MAX_LEN` bytes.
+ *
+ * @return number of bytes written
+ */
+size_t app_burst_frame_encode(uint8_t *buf, const int32_t *frame, const int32_t *prev,
+			      size_t count);
+
+/**
+ * Number of documents needed for `data_len` bytes of frames, at most
+ * `part_len` bytes each. A capture without frames still takes one.
+ */
+size_t app_burst_part_count(size_t data_len, size_t part_len);
+
+/** Length of the data of part number `part` */
+size_t app_burst_part_len(size_t data_len, size_t part_len, size_t part);
+
+#endif /* __APP_BURST_CODEC_H__ */
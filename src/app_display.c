@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_display, LOG_LEVEL_DBG);
+
+#include <string.h>
+#include <libostentus.h>
+#include <libostentus_regmap.h>
+#include <zephyr/kernel.h>
+
+#include "app_boot.h"
+#include "app_display.h"
+#include "app_prof.h"
+
+static const struct device *o_dev = DEVICE_DT_GET_ANY(golioth_ostentus);
+
+struct slide_shadow {
+	/* Latest value posted by the application */
+	char posted[APP_DISPLAY_VALUE_LEN];
+	/* Value last written to the faceplate */
+	char shown[APP_DISPLAY_VALUE_LEN];
+	bool dirty;
+};
+
+static struct slide_shadow slides[SLIDE_KEY_COUNT];
+static K_MUTEX_DEFINE(display_lock);
+
+static K_THREAD_STACK_DEFINE(display_stack, CONFIG_APP_DISPLAY_STACK_SIZE);
+static struct k_work_q display_work_q;
+
+static void display_setup_handler(struct k_work *work);
+static K_WORK_DEFINE(display_setup_work, display_setup_handler);
+
+static void display_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(display_work, display_work_handler);
+
+/* Uptime of the last faceplate update */
+static int64_t last_refresh_ms;
+
+/* Bring up the faceplate; slide updates queued meanwhile run after this */
+static void display_setup_handler(struct k_work *work)
+{
+	char o_version[32] = {0};
+
+	/* Reset Ostentus and pause for reboot */
+	ostentus_reset(o_dev);
+	k_msleep(300);
+
+	/* Read firmware version from faceplate */
+	ostentus_version_get(o_dev, o_version, sizeof(o_version) - 1);
+	LOG_INF("Ostentus reports firmware version: %s", o_version);
+
+	/* Update Ostentus LEDS using bitmask (Power On and Battery) */
+	ostentus_led_bitmask(o_dev, LED_POW | LED_BAT);
+
+	/* Show Golioth Logo on Ostentus ePaper screen */
+	ostentus_show_splash(o_dev);
+
+	/* Set up a slideshow on Ostentus
+	 *  - add up to 256 slides
+	 *  - sensor channels with a slide label get a slide (see app_sensors.h)
+	 *  - use the enum in app_sensors.h to add other keys
+	 *  - values are updated using these keys (see app_sensors.c)
+	 */
+	for (int i = 0; i < APP_CH_COUNT; i++) {
+		const char *label = app_channels[i].slide_label;
+
+		if (label) {
+			ostentus_slide_add(o_dev, i, (char *)label, strlen(label));
+		}
+	}
+
+	IF_ENABLED(CONFIG_ALUDEL_BATTERY_MONITOR, (
+		ostentus_slide_add(o_dev, BATTERY_V, LABEL_BATTERY, strlen(LABEL_BATTERY));
+		ostentus_slide_add(o_dev, BATTERY_PCT, LABEL_BATTERY, strlen(LABEL_BATTERY));
+	));
+	ostentus_slide_add(o_dev, FIRMWARE, LABEL_FIRMWARE, strlen(LABEL_FIRMWARE));
+
+	/* Set the title of the Ostentus summary slide (optional) */
+	ostentus_summary_title(o_dev, SUMMARY_TITLE, strlen(SUMMARY_TITLE));
+
+	/* Start Ostentus slideshow with 30 second delay between slides */
+	ostentus_slideshow(o_dev, 30000);
+
+	app_boot_mark(APP_BOOT_DISPLAY);
+}
+
+static void display_work_handler(struct k_work *work)
+{
+	char value[APP_DISPLAY_VALUE_LEN];
+	uint32_t prof_start;
+	int pushed = 0;
+	int err;
+
+	for (int key = 0; key < SLIDE_KEY_COUNT; key++) {
+		struct slide_shadow *slide = &slides[key];
+
+		k_mutex_lock(&display_lock, K_FOREVER);
+		if (!slide->dirty) {
+			k_mutex_unlock(&display_lock);
+			continue;
+		}
+		memcpy(value, slide->posted, sizeof(value));
+		slide->dirty = false;
+		k_mutex_unlock(&display_lock);
+
+		/* Only this work item touches `shown` */
+		if (strcmp(value, slide->shown) == 0) {
+			continue;
+		}
+
+		prof_start = app_prof_start();
+		err = ostentus_slide_set(o_dev, key, value, strlen(value));
+		app_prof_record(APP_PROF_DISPLAY, prof_start);
+		if (err) {
+			LOG_WRN("Failed to update slide %d: %d", key, err);
+			continue;
+		}
+
+		memcpy(slide->shown, value, sizeof(slide->shown));
+		pushed++;
+	}
+
+	if (pushed) {
+		k_mutex_lock(&display_lock, K_FOREVER);
+		last_refresh_ms = k_uptime_get();
+		k_mutex_unlock(&display_lock);
+
+		LOG_DBG("Updated %d slides", pushed);
+	}
+}
+
+void app_display_slide_set(slide_key key, const char *value)
+{
+	int64_t next_ms;
+
+	if (key >= SLIDE_KEY_COUNT) {
+		return;
+	}
+
+	k_mutex_lock(&display_lock, K_FOREVER);
+	strncpy(slides[key].posted, value, APP_DISPLAY_VALUE_LEN - 1);
+	slides[key].dirty = true;
+	next_ms = last_refresh_ms + CONFIG_APP_DISPLAY_REFRESH_MS - k_uptime_get();
+	k_mutex_unlock(&display_lock);
+
+	/* Coalesces with an update that is already scheduled */
+	k_work_schedule_for_queue(&display_work_q, &display_work, K_MSEC(MAX(next_ms, 0)));
+}
+
+void app_display_init(void)
+{
+	struct k_work_queue_config display_cfg = {
+		.name = "display_workq",
+	};
+
+	last_refresh_ms = -CONFIG_APP_DISPLAY_REFRESH_MS;
+
+	k_work_queue_init(&display_work_q);
+	k_work_queue_start(&display_work_q, display_stack, K_THREAD_STACK_SIZEOF(display_stack),
+			   K_LOWEST_APPLICATION_THREAD_PRIO, &display_cfg);
+
+	k_work_submit_to_queue(&display_work_q, &display_setup_work);
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Deferred Ostentus slide updates.
+ *
+ * Writing a slide is a synchronous I2C transaction with the faceplate, so the
+ * sensor loop only posts the rendered value of each slide here and returns.
+ * A dedicated work queue keeps a shadow of what the faceplate shows and
+ * pushes only the slides whose text changed, at most once every
+ * `CONFIG_APP_DISPLAY_REFRESH_MS`. Values posted in between replace each
+ * other, so the faceplate always ends up showing the latest ones.
+ *
+ * The faceplate is reset and its slideshow set up on the same work queue, so
+ * `app_display_init()` returns immediately and values posted during the
+ * faceplate's reset are shown once it is ready.
+ */
+
+#ifndef __APP_DISPLAY_H__
+#define __APP_DISPLAY_H__
+
+#include "app_sensors.h"
+
+/* Longest slide value, including the terminating NUL */
+#define APP_DISPLAY_VALUE_LEN 32
+
+void app_display_init(void);
+
+/**
+ * Post the value shown on a slide; never blocks on the faceplate.
+ *
+ * @param key slide key (see app_sensors.h)
+ * @param value text to show, truncated to APP_DISPLAY_VALUE_LEN - 1 characters
+ */
+void app_display_slide_set(slide_key key, const char *value);
+
+#endif /* __APP_DISPLAY_H__ */
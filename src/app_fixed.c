@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#ifdef CONFIG_ZCBOR
+#include <zcbor_encode.h>
+#endif
+
+#include "app_fixed.h"
+
+/* Mantissa bits of a float, excluding the implicit leading one */
+#define FLOAT32_MANT_BITS 23
+#define FLOAT32_EXP_BIAS 127
+#define FLOAT32_SIGN (1U << 31)
+
+uint32_t fixed_to_float32_bits(int64_t num, uint64_t den)
+{
+	uint32_t sign = (num < 0) ? FLOAT32_SIGN : 0;
+	uint64_t n = (num < 0) ? -(uint64_t)num : (uint64_t)num;
+	uint32_t mant = 0;
+	int exp = 0;
+
+	if (n == 0) {
+		return sign;
+	}
+
+	/* Scale so that 1 <= n / den < 2 */
+	while (n < den) {
+		n <<= 1;
+		exp--;
+	}
+	while ((n >> 1) >= den) {
+		den <<= 1;
+		exp++;
+	}
+
+	/* Long division: the leading one, the mantissa and one rounding bit */
+	for (int i = 0; i < FLOAT32_MANT_BITS + 2; i++) {
+		mant <<= 1;
+		if (n >= den) {
+			n -= den;
+			mant |= 1;
+		}
+		n <<= 1;
+	}
+
+	mant = (mant + 1) >> 1;
+	if (mant >> (FLOAT32_MANT_BITS + 1)) {
+		/* Rounding carried into the next power of two */
+		mant >>= 1;
+		exp++;
+	}
+
+	return sign | ((uint32_t)(exp + FLOAT32_EXP_BIAS) << FLOAT32_MANT_BITS) |
+	       (mant & ((1U << FLOAT32_MANT_BITS) - 1));
+}
+
+#ifdef CONFIG_ZCBOR
+bool fixed_float32_put(zcbor_state_t *zse, int64_t num, uint64_t den)
+{
+	uint32_t bits = fixed_to_float32_bits(num, den);
+	float value;
+
+	/* Reinterpret the bits; no floating point arithmetic is involved */
+	memcpy(&value, &bits, sizeof(value));
+
+	return zcbor_float32_encode(zse, &value);
+}
+#endif
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Fixed-point helpers for the sensor data path.
+ *
+ * Readings with a fractional part are carried as int32 milli-units from the
+ * moment they are fetched until they are encoded. They are printed with
+ * integer formatting (`PRIMILLI`) and converted to IEEE-754 single precision
+ * with integer arithmetic only where a CBOR float is required, so neither
+ * floating point printf support nor soft-float routines are needed.
+ */
+
+#ifndef __APP_FIXED_H__
+#define __APP_FIXED_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#ifdef CONFIG_ZCBOR
+#include <zcbor_common.h>
+#endif
+
+#define MILLI_PER_UNIT 1000
+
+/**
+ * Print a milli-unit value with three decimals:
+ * `printk("T=" PRIMILLI, MILLI_ARGS(temp))`
+ */
+#define PRIMILLI "%s%lld.%03u"
+#define MILLI_ARGS(_milli)                                                                         \
+	((_milli) < 0 ? "-" : ""),                                                                 \
+		(long long)(((_milli) < 0 ? -(int64_t)(_milli) : (int64_t)(_milli)) /              \
+			    MILLI_PER_UNIT),                                                       \
+		(unsigned int)(((_milli) < 0 ? -(int64_t)(_milli) : (int64_t)(_milli)) %           \
+			       MILLI_PER_UNIT)
+
+/**
+ * IEEE-754 single precision representation of `num / den`, rounded to nearest,
+ * computed without floating point operations.
+ *
+ * @param den must not be 0 and must be smaller than 2^63
+ */
+uint32_t fixed_to_float32_bits(int64_t num, uint64_t den);
+
+#ifdef CONFIG_ZCBOR
+/** Encode `num / den` as a CBOR float32 */
+bool fixed_float32_put(zcbor_state_t *zse, int64_t num, uint64_t den);
+#endif
+
+#endif /* __APP_FIXED_H__ */
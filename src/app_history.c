@@ -0,0 +1,474 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_history, LOG_LEVEL_DBG);
+
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zcbor_encode.h>
+
+#ifdef CONFIG_APP_HISTORY_FLASH
+#include <zephyr/fs/fcb.h>
+#include <zephyr/storage/flash_map.h>
+#endif
+
+#include "app_history.h"
+#include "app_time.h"
+
+/* `time` is a Unix time; otherwise it is an uptime of the current boot */
+#define HISTORY_F_UNIX BIT(0)
+
+/* Sample, or mean of the samples of one period */
+struct history_entry {
+	/* Capture time, or start of the period, in seconds */
+	uint32_t time;
+	/* Number of samples */
+	uint16_t count;
+	uint16_t flags;
+	/* Bit n is set when `val[n]` holds a value */
+	uint32_t mask;
+	int32_t val[APP_CH_COUNT];
+};
+
+/*
+ * Entry number `seq` of a tier is kept at `entries[seq % len]`, so the tier
+ * holds entries `head - len` to `head - 1` once it has wrapped. Sequence
+ * numbers are the cursors of paged queries.
+ */
+struct history_tier {
+	const char *name;
+	uint32_t period_s;
+	struct history_entry *entries;
+	uint32_t len;
+	uint32_t head;
+};
+
+/* Sums of the samples of the period in progress */
+struct history_accum {
+	int64_t sum[APP_CH_COUNT];
+	uint32_t n[APP_CH_COUNT];
+	uint32_t count;
+	uint32_t mask;
+	/* Period in progress, in periods since boot */
+	uint32_t period;
+};
+
+enum history_tier_id {
+	HISTORY_RAW,
+	HISTORY_MINUTE,
+	HISTORY_HOUR,
+	HISTORY_TIER_COUNT
+};
+
+static struct history_entry raw_entries[CONFIG_APP_HISTORY_RAW_LEN];
+static struct history_entry minute_entries[CONFIG_APP_HISTORY_MINUTE_LEN];
+static struct history_entry hour_entries[CONFIG_APP_HISTORY_HOUR_LEN];
+
+static struct history_tier tiers[HISTORY_TIER_COUNT] = {
+	[HISTORY_RAW] = {"raw", 0, raw_entries, ARRAY_SIZE(raw_entries)},
+	[HISTORY_MINUTE] = {"minute", 60, minute_entries, ARRAY_SIZE(minute_entries)},
+	[HISTORY_HOUR] = {"hour", 3600, hour_entries, ARRAY_SIZE(hour_entries)},
+};
+
+static struct history_accum minute_accum;
+static struct history_accum hour_accum;
+
+/* Serializes the sensor thread adding samples and RPC queries */
+static K_MUTEX_DEFINE(history_mutex);
+
+/*
+ * Largest encoding of a row: list header, time, count and mask, then one value
+ * per channel, with 5 bytes for any 32-bit integer
+ */
+#define HISTORY_ROW_MAX_LEN (2 + 5 + 3 + 5 + 5 * APP_CH_COUNT)
+
+/* Room kept for closing the rows list, `next` and the response map */
+#define HISTORY_PAGE_RESERVE 16
+
+static void tier_push(struct history_tier *tier, const struct history_entry *entry)
+{
+	tier->entries[tier->head % tier->len] = *entry;
+	tier->head++;
+}
+
+static uint32_t tier_oldest(const struct history_tier *tier)
+{
+	return (tier->head > tier->len) ? (tier->head - tier->len) : 0;
+}
+
+#ifdef CONFIG_APP_HISTORY_FLASH
+
+#define HISTORY_PARTITION_ID FIXED_PARTITION_ID(history_storage)
+#define HISTORY_MAGIC	     0x48495354 /* "HIST" */
+
+/* Bump whenever the layout of struct history_entry changes */
+#define HISTORY_VERSION 1
+
+static struct flash_sector history_sectors[CONFIG_APP_HISTORY_SECTORS_MAX];
+static struct fcb history_fcb;
+static bool history_flash_ready;
+
+static int history_fcb_init(void)
+{
+	uint32_t sector_cnt = ARRAY_SIZE(history_sectors);
+	int err;
+
+	err = flash_area_get_sectors(HISTORY_PARTITION_ID, &sector_cnt, history_sectors);
+	if (err) {
+		LOG_ERR("Unable to get history storage sectors: %d", err);
+		return err;
+	}
+
+	history_fcb.f_magic = HISTORY_MAGIC;
+	history_fcb.f_version = HISTORY_VERSION;
+	history_fcb.f_sectors = history_sectors;
+	history_fcb.f_sector_cnt = sector_cnt;
+	history_fcb.f_scratch_cnt = 0;
+
+	return fcb_init(HISTORY_PARTITION_ID, &history_fcb);
+}
+
+static int history_restore_cb(struct fcb_entry_ctx *entry_ctx, void *arg)
+{
+	struct history_entry entry;
+	int err;
+
+	if (entry_ctx->loc.fe_data_len != sizeof(entry)) {
+		LOG_WRN("Skipping history entry of %u bytes", entry_ctx->loc.fe_data_len);
+		return 0;
+	}
+
+	err = flash_area_read(entry_ctx->fap, FCB_ENTRY_FA_DATA_OFF(entry_ctx->loc), &entry,
+			      sizeof(entry));
+	if (err) {
+		return err;
+	}
+
+	/* Oldest first, so the tier ends up with the most recent hours */
+	tier_push(&tiers[HISTORY_HOUR], &entry);
+	(*(size_t *)arg)++;
+
+	return 0;
+}
+
+static int history_flash_init(void)
+{
+	const struct flash_area *fa;
+	size_t count = 0;
+	int err;
+
+	err = history_fcb_init();
+	if (err) {
+		/* Written by an incompatible firmware or never formatted */
+		LOG_WRN("Erasing history storage (%d)", err);
+
+		err = flash_area_open(HISTORY_PARTITION_ID, &fa);
+		if (err) {
+			LOG_ERR("Unable to open history storage: %d", err);
+			return err;
+		}
+
+		err = flash_area_erase(fa, 0, fa->fa_size);
+		flash_area_close(fa);
+		if (err) {
+			LOG_ERR("Unable to erase history storage: %d", err);
+			return err;
+		}
+
+		err = history_fcb_init();
+		if (err) {
+			LOG_ERR("Unable to initialize history storage: %d", err);
+			return err;
+		}
+	}
+
+	fcb_walk(&history_fcb, NULL, history_restore_cb, &count);
+	LOG_INF("History storage: %u sectors, %zu hours restored", history_fcb.f_sector_cnt,
+		count);
+
+	history_flash_ready = true;
+
+	return 0;
+}
+
+static int history_flash_append(const struct history_entry *entry)
+{
+	struct fcb_entry loc;
+	int err;
+
+	if (!history_flash_ready) {
+		return -ENODEV;
+	}
+
+	err = fcb_append(&history_fcb, sizeof(*entry), &loc);
+	if (err == -ENOSPC) {
+		err = fcb_rotate(&history_fcb);
+		if (err) {
+			return err;
+		}
+
+		err = fcb_append(&history_fcb, sizeof(*entry), &loc);
+	}
+	if (err) {
+		return err;
+	}
+
+	err = flash_area_write(history_fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc), entry,
+			       sizeof(*entry));
+	if (err) {
+		return err;
+	}
+
+	return fcb_append_finish(&history_fcb, &loc);
+}
+
+#endif /* CONFIG_APP_HISTORY_FLASH */
+
+static void accum_add(struct history_accum *acc, const int64_t *sum, const uint32_t *n,
+		      uint32_t mask, uint32_t count)
+{
+	for (int i = 0; i < APP_CH_COUNT; i++) {
+		if (mask & BIT(i)) {
+			acc->sum[i] += sum[i];
+			acc->n[i] += n[i];
+		}
+	}
+
+	acc->mask |= mask;
+	acc->count += count;
+}
+
+/* Turn the period in progress into an entry and start a new one */
+static void accum_close(struct history_accum *acc, uint32_t period_s,
+			struct history_entry *entry)
+{
+	entry->time = acc->period * period_s;
+	entry->count = MIN(acc->count, UINT16_MAX);
+	entry->flags = 0;
+	entry->mask = acc->mask;
+
+	for (int i = 0; i < APP_CH_COUNT; i++) {
+		if (acc->n[i]) {
+			/* Rounded to nearest */
+			int64_t half = (acc->sum[i] < 0) ? -(int64_t)(acc->n[i] / 2)
+							 : (int64_t)(acc->n[i] / 2);
+
+			entry->val[i] = (acc->sum[i] + half) / (int64_t)acc->n[i];
+		} else {
+			entry->val[i] = 0;
+		}
+	}
+
+	memset(acc, 0, sizeof(*acc));
+}
+
+static void hour_close(void)
+{
+	struct history_entry entry;
+	int64_t unix_ms;
+
+	accum_close(&hour_accum, tiers[HISTORY_HOUR].period_s, &entry);
+
+	/* Hours are kept across reboots, so they need a time that survives one */
+	if (app_time_to_unix_ms((int64_t)entry.time * MSEC_PER_SEC, &unix_ms) == 0) {
+		entry.time = unix_ms / MSEC_PER_SEC;
+		entry.flags |= HISTORY_F_UNIX;
+
+#ifdef CONFIG_APP_HISTORY_FLASH
+		int err = history_flash_append(&entry);
+
+		if (err) {
+			LOG_WRN("Unable to save hour to flash: %d", err);
+		}
+#endif
+	}
+
+	tier_push(&tiers[HISTORY_HOUR], &entry);
+}
+
+/* Minutes roll up into hours: their sums, not their means, are carried over */
+static void minute_close(void)
+{
+	uint32_t hour = minute_accum.period * tiers[HISTORY_MINUTE].period_s /
+			tiers[HISTORY_HOUR].period_s;
+	struct history_entry entry;
+
+	if (hour_accum.count && hour_accum.period != hour) {
+		hour_close();
+	}
+
+	hour_accum.period = hour;
+	accum_add(&hour_accum, minute_accum.sum, minute_accum.n, minute_accum.mask,
+		  minute_accum.count);
+
+	accum_close(&minute_accum, tiers[HISTORY_MINUTE].period_s, &entry);
+	tier_push(&tiers[HISTORY_MINUTE], &entry);
+}
+
+void app_history_add(const struct app_sample *sample)
+{
+	uint32_t uptime_s = sample->uptime_ms / MSEC_PER_SEC;
+	uint32_t minute = uptime_s / tiers[HISTORY_MINUTE].period_s;
+	struct history_entry entry = {
+		.time = uptime_s,
+		.count = 1,
+		.mask = sample->mask,
+	};
+	int64_t sum[APP_CH_COUNT];
+	uint32_t n[APP_CH_COUNT];
+
+	for (int i = 0; i < APP_CH_COUNT; i++) {
+		entry.val[i] = (sample->mask & BIT(i)) ? sample->val[i] : 0;
+		sum[i] = entry.val[i];
+		n[i] = 1;
+	}
+
+	k_mutex_lock(&history_mutex, K_FOREVER);
+
+	tier_push(&tiers[HISTORY_RAW], &entry);
+
+	if (minute_accum.count && minute_accum.period != minute) {
+		minute_close();
+	}
+
+	minute_accum.period = minute;
+	accum_add(&minute_accum, sum, n, sample->mask, 1);
+
+	k_mutex_unlock(&history_mutex);
+}
+
+int app_history_init(void)
+{
+	COND_CODE_1(CONFIG_APP_HISTORY_FLASH, (return history_flash_init();), (return 0;));
+}
+
+/* Unix time of an entry in seconds, or -EAGAIN while there is no time base */
+static int entry_unix_time(const struct history_entry *entry, int64_t *unix_s)
+{
+	int64_t unix_ms;
+	int err;
+
+	if (entry->flags & HISTORY_F_UNIX) {
+		*unix_s = entry->time;
+		return 0;
+	}
+
+	err = app_time_to_unix_ms((int64_t)entry->time * MSEC_PER_SEC, &unix_ms);
+	if (err) {
+		return err;
+	}
+
+	*unix_s = unix_ms / MSEC_PER_SEC;
+
+	return 0;
+}
+
+static bool encode_channels(zcbor_state_t *map)
+{
+	char name[32];
+	bool ok;
+
+	ok = zcbor_tstr_put_lit(map, "channels") && zcbor_list_start_encode(map, APP_CH_COUNT);
+
+	for (int i = 0; ok && i < APP_CH_COUNT; i++) {
+		int len = snprintf(name, sizeof(name), "%s/%s", app_channels[i].group,
+				   app_channels[i].key);
+
+		ok = zcbor_tstr_encode_ptr(map, name, MIN(len, sizeof(name) - 1));
+	}
+
+	return ok && zcbor_list_end_encode(map, APP_CH_COUNT);
+}
+
+static bool encode_row(zcbor_state_t *map, const struct history_entry *entry, int64_t unix_s)
+{
+	size_t count = 3 + POPCOUNT(entry->mask);
+	bool ok;
+
+	ok = zcbor_list_start_encode(map, count) && zcbor_int64_put(map, unix_s) &&
+	     zcbor_uint32_put(map, entry->count) && zcbor_uint32_put(map, entry->mask);
+
+	for (int i = 0; ok && i < APP_CH_COUNT; i++) {
+		if (entry->mask & BIT(i)) {
+			ok = zcbor_int32_put(map, entry->val[i]);
+		}
+	}
+
+	return ok && zcbor_list_end_encode(map, count);
+}
+
+int app_history_query(zcbor_state_t *map, const uint8_t *tier_name, size_t tier_len,
+		      int64_t from_s, int64_t to_s, uint32_t cursor)
+{
+	const struct history_tier *tier = NULL;
+	bool more = false;
+	size_t rows = 0;
+	uint32_t seq;
+	int64_t unix_s;
+	bool ok;
+
+	for (int i = 0; i < HISTORY_TIER_COUNT; i++) {
+		if (strlen(tiers[i].name) == tier_len &&
+		    memcmp(tiers[i].name, tier_name, tier_len) == 0) {
+			tier = &tiers[i];
+			break;
+		}
+	}
+
+	if (tier == NULL) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&history_mutex, K_FOREVER);
+
+	/* A cursor past the newest entry was not handed out by this boot */
+	if (cursor > tier->head) {
+		k_mutex_unlock(&history_mutex);
+		return -ERANGE;
+	}
+
+	ok = zcbor_tstr_put_lit(map, "period_s") && zcbor_uint32_put(map, tier->period_s);
+
+	if (ok && cursor == 0) {
+		ok = encode_channels(map);
+	}
+
+	ok = ok && zcbor_tstr_put_lit(map, "rows") && zcbor_list_start_encode(map, tier->len);
+
+	/* Entries older than the cursor may have been overwritten since the last page */
+	for (seq = MAX(cursor, tier_oldest(tier)); ok && seq < tier->head; seq++) {
+		const struct history_entry *entry = &tier->entries[seq % tier->len];
+
+		if (entry_unix_time(entry, &unix_s) || unix_s < from_s || unix_s > to_s) {
+			continue;
+		}
+
+		if (map->payload_end - map->payload < HISTORY_ROW_MAX_LEN + HISTORY_PAGE_RESERVE) {
+			more = true;
+			break;
+		}
+
+		ok = encode_row(map, entry, unix_s);
+		rows++;
+	}
+
+	ok = ok && zcbor_list_end_encode(map, tier->len);
+
+	if (ok && more) {
+		ok = zcbor_tstr_put_lit(map, "next") && zcbor_uint32_put(map, seq);
+	}
+
+	k_mutex_unlock(&history_mutex);
+
+	if (!ok || (more && rows == 0)) {
+		return -ENOMEM;
+	}
+
+	return 0;
+}
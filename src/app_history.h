@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * On-device history of the sensor channels.
+ *
+ * Every sample is kept in three tiers so that data lost upstream can be read
+ * back from the device with the `get_history` RPC (see app_rpc.h):
+ *
+ *  - `raw`: the last `CONFIG_APP_HISTORY_RAW_LEN` samples
+ *  - `minute`: the mean of each channel over each minute, for the last
+ *    `CONFIG_APP_HISTORY_MINUTE_LEN` minutes
+ *  - `hour`: the mean of each channel over each hour, for the last
+ *    `CONFIG_APP_HISTORY_HOUR_LEN` hours
+ *
+ * Each tier is a circular buffer in static memory, so adding a sample takes
+ * constant time and the memory used is fixed at build time. The minute and
+ * hour means are accumulated as samples arrive and added to their tier when
+ * the next sample falls in a new minute or hour since boot.
+ *
+ * With `CONFIG_APP_HISTORY_FLASH`, hourly entries are also appended to a
+ * flash circular buffer in the `history_storage` partition and the hour tier
+ * is restored from it at boot.
+ *
+ * Entries are returned with Unix timestamps. Entries of the current boot are
+ * converted with the time base of app_time.h when queried, and left out until
+ * the first network time is obtained. Only hours that end once it is known
+ * are saved to flash.
+ */
+
+#ifndef __APP_HISTORY_H__
+#define __APP_HISTORY_H__
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zcbor_encode.h>
+
+#include "app_sensors.h"
+
+#ifdef CONFIG_APP_HISTORY
+
+/** Restore the hour tier from flash; call before the first sample */
+int app_history_init(void);
+
+/** Add a sample to every tier */
+void app_history_add(const struct app_sample *sample);
+
+/**
+ * Add one page of history to an open zcbor map: the entries of a tier taken
+ * between two Unix times, as many as fit in the map's buffer.
+ *
+ * @param map Open map; its buffer bounds the page size
+ * @param tier Tier name, `raw`, `minute` or `hour`
+ * @param tier_len Length of `tier`
+ * @param from_s First Unix time included, in seconds
+ * @param to_s Last Unix time included, in seconds
+ * @param cursor 0 for the first page, or `next` from the previous page
+ *
+ * @return 0, -EINVAL for an unknown tier, -ERANGE for a cursor past the newest
+ * entry, or -ENOMEM if not even one entry fits
+ */
+int app_history_query(zcbor_state_t *map, const uint8_t *tier, size_t tier_len, int64_t from_s,
+		      int64_t to_s, uint32_t cursor);
+
+#else
+
+static inline int app_history_init(void)
+{
+	return 0;
+}
+
+static inline void app_history_add(const struct app_sample *sample)
+{
+}
+
+static inline int app_history_query(zcbor_state_t *map, const uint8_t *tier, size_t tier_len,
+				    int64_t from_s, int64_t to_s, uint32_t cursor)
+{
+	return -ENOTSUP;
+}
+
+#endif /* CONFIG_APP_HISTORY */
+
+#endif /* __APP_HISTORY_H__ */
@@ -0,0 +1,421 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_imu, LOG_LEVEL_DBG);
+
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "app_imu.h"
+#include "app_sched.h"
+
+#define LIS2DH_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(st_lis2dh)
+BUILD_ASSERT(DT_ON_BUS(LIS2DH_NODE, i2c), "LIS2DH FIFO access requires an I2C bus");
+
+/* LIS2DH registers used on top of the Zephyr driver */
+#define LIS2DH_REG_CTRL1 0x20
+#define LIS2DH_CTRL1_LPEN BIT(3)
+#define LIS2DH_REG_CTRL4 0x23
+#define LIS2DH_CTRL4_FS_SHIFT 4
+#define LIS2DH_CTRL4_FS_MASK (BIT_MASK(2) << LIS2DH_CTRL4_FS_SHIFT)
+#define LIS2DH_CTRL4_HR BIT(3)
+#define LIS2DH_REG_CTRL5 0x24
+#define LIS2DH_CTRL5_FIFO_EN BIT(6)
+#define LIS2DH_REG_OUT_X_L 0x28
+#define LIS2DH_REG_FIFO_CTRL 0x2E
+#define LIS2DH_FIFO_MODE_STREAM (0x2 << 6)
+#define LIS2DH_REG_FIFO_SRC 0x2F
+#define LIS2DH_FIFO_SRC_OVRN BIT(6)
+#define LIS2DH_FIFO_SRC_EMPTY BIT(5)
+#define LIS2DH_FIFO_SRC_FSS_MASK BIT_MASK(5)
+
+/* Set the MSB of the register address to read several registers at once */
+#define LIS2DH_AUTO_INCREMENT BIT(7)
+
+#define LIS2DH_FIFO_DEPTH 32
+#define LIS2DH_SAMPLE_LEN 6
+
+/* Do not wake the system thread more often than this while the device moves */
+#define MOTION_WAKE_HOLDOFF_MS 5000
+
+/* The FIFO is read once it is 3/4 full, if nothing else read it meanwhile */
+#define FIFO_POLL_DELAY(_odr_hz) K_MSEC((LIS2DH_FIFO_DEPTH * 3 / 4) * MSEC_PER_SEC / (_odr_hz))
+
+static const struct i2c_dt_spec imu_i2c = I2C_DT_SPEC_GET(LIS2DH_NODE);
+
+/*
+ * Output registers are left-justified. Resolution (right shift) and
+ * sensitivity (mg per digit) depend on the operating mode and full scale
+ * selected by the driver; both are read back once at init.
+ */
+static uint8_t sample_shift;
+static uint8_t sample_mg;
+
+static const struct device *imu_dev;
+
+static uint8_t fifo_buf[LIS2DH_FIFO_DEPTH * LIS2DH_SAMPLE_LEN];
+
+/* Samples read from the FIFO, in mg */
+struct fifo_acc {
+	int64_t sum[3];
+	int32_t min[3];
+	int32_t max[3];
+	uint32_t count;
+	uint32_t overruns;
+};
+
+/*
+ * Samples read since the last drain. Burst captures and the poll work read
+ * the FIFO too, so their samples still reach the loop's window.
+ */
+static K_MUTEX_DEFINE(fifo_mutex);
+static struct fifo_acc fifo_acc;
+static uint16_t fifo_odr_hz = CONFIG_APP_IMU_ODR_HZ;
+
+static void fifo_poll_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(fifo_poll_work, fifo_poll_handler);
+
+static atomic_t motion_count = ATOMIC_INIT(0);
+
+/* mg per digit, indexed by full scale (2, 4, 8, 16 g) */
+static const uint8_t mg_per_digit_hr[] = {1, 2, 4, 12};
+static const uint8_t mg_per_digit_normal[] = {4, 8, 16, 48};
+static const uint8_t mg_per_digit_lp[] = {16, 32, 64, 192};
+
+static int imu_read_format(void)
+{
+	uint8_t ctrl1;
+	uint8_t ctrl4;
+	uint8_t fs;
+	int err;
+
+	err = i2c_reg_read_byte_dt(&imu_i2c, LIS2DH_REG_CTRL1, &ctrl1);
+	if (err) {
+		return err;
+	}
+
+	err = i2c_reg_read_byte_dt(&imu_i2c, LIS2DH_REG_CTRL4, &ctrl4);
+	if (err) {
+		return err;
+	}
+
+	fs = (ctrl4 & LIS2DH_CTRL4_FS_MASK) >> LIS2DH_CTRL4_FS_SHIFT;
+
+	if (ctrl1 & LIS2DH_CTRL1_LPEN) {
+		sample_shift = 8;
+		sample_mg = mg_per_digit_lp[fs];
+	} else if (ctrl4 & LIS2DH_CTRL4_HR) {
+		sample_shift = 4;
+		sample_mg = mg_per_digit_hr[fs];
+	} else {
+		sample_shift = 6;
+		sample_mg = mg_per_digit_normal[fs];
+	}
+
+	return 0;
+}
+
+static int imu_fifo_enable(void)
+{
+	int err;
+
+	err = i2c_reg_update_byte_dt(&imu_i2c, LIS2DH_REG_CTRL5, LIS2DH_CTRL5_FIFO_EN,
+				     LIS2DH_CTRL5_FIFO_EN);
+	if (err) {
+		return err;
+	}
+
+	/* Stream mode: once full, the oldest sample is overwritten */
+	return i2c_reg_write_byte_dt(&imu_i2c, LIS2DH_REG_FIFO_CTRL, LIS2DH_FIFO_MODE_STREAM);
+}
+
+/* mg to milli m/s^2; SENSOR_G is in micro m/s^2 */
+static int32_t mg_to_accel(int64_t mg)
+{
+	return (mg * SENSOR_G) / 1000000;
+}
+
+static void acc_reset(struct fifo_acc *acc)
+{
+	memset(acc, 0, sizeof(*acc));
+
+	for (int axis = 0; axis < 3; axis++) {
+		acc->min[axis] = INT32_MAX;
+		acc->max[axis] = INT32_MIN;
+	}
+}
+
+static void acc_merge(struct fifo_acc *dst, const struct fifo_acc *src)
+{
+	for (int axis = 0; axis < 3; axis++) {
+		dst->sum[axis] += src->sum[axis];
+		dst->min[axis] = MIN(dst->min[axis], src->min[axis]);
+		dst->max[axis] = MAX(dst->max[axis], src->max[axis]);
+	}
+
+	dst->count += src->count;
+	dst->overruns += src->overruns;
+}
+
+static void acc_mean(const struct fifo_acc *acc, int32_t accel[3])
+{
+	for (int axis = 0; axis < 3; axis++) {
+		accel[axis] = mg_to_accel(acc->sum[axis] / (int64_t)acc->count);
+	}
+}
+
+/*
+ * Read every sample waiting in the FIFO into `acc`; call with fifo_mutex held.
+ * Any read postpones the poll work, so it only runs when nothing else read the
+ * FIFO for most of its depth.
+ */
+static int fifo_read(struct fifo_acc *acc)
+{
+	uint8_t src;
+	size_t count;
+	int err;
+
+	k_work_reschedule(&fifo_poll_work, FIFO_POLL_DELAY(fifo_odr_hz));
+
+	err = i2c_reg_read_byte_dt(&imu_i2c, LIS2DH_REG_FIFO_SRC, &src);
+	if (err) {
+		return err;
+	}
+
+	if (src & LIS2DH_FIFO_SRC_EMPTY) {
+		return -ENODATA;
+	}
+
+	/* Full, and the oldest samples have been overwritten */
+	if (src & LIS2DH_FIFO_SRC_OVRN) {
+		acc->overruns++;
+	}
+
+	count = (src & LIS2DH_FIFO_SRC_OVRN) ? LIS2DH_FIFO_DEPTH : (src & LIS2DH_FIFO_SRC_FSS_MASK);
+	if (count == 0) {
+		return -ENODATA;
+	}
+
+	/* With the FIFO enabled the address wraps from OUT_Z_H back to OUT_X_L */
+	err = i2c_burst_read_dt(&imu_i2c, LIS2DH_REG_OUT_X_L | LIS2DH_AUTO_INCREMENT, fifo_buf,
+				count * LIS2DH_SAMPLE_LEN);
+	if (err) {
+		return err;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		for (int axis = 0; axis < 3; axis++) {
+			int16_t raw = sys_get_le16(&fifo_buf[(i * LIS2DH_SAMPLE_LEN) + (2 * axis)]);
+			int32_t mg = (raw >> sample_shift) * sample_mg;
+
+			acc->sum[axis] += mg;
+			acc->min[axis] = MIN(acc->min[axis], mg);
+			acc->max[axis] = MAX(acc->max[axis], mg);
+		}
+	}
+
+	acc->count += count;
+
+	return count;
+}
+
+static void fifo_poll_handler(struct k_work *work)
+{
+	int err;
+
+	k_mutex_lock(&fifo_mutex, K_FOREVER);
+	err = fifo_read(&fifo_acc);
+	k_mutex_unlock(&fifo_mutex);
+
+	if ((err < 0) && (err != -ENODATA)) {
+		LOG_WRN("Failed to read LIS2DH FIFO: %d", err);
+	}
+}
+
+int app_imu_fifo_drain(struct app_imu_window *window)
+{
+	struct fifo_acc acc;
+	int32_t p2p = 0;
+	int err;
+
+	k_mutex_lock(&fifo_mutex, K_FOREVER);
+
+	err = fifo_read(&fifo_acc);
+	if ((err < 0) && (err != -ENODATA)) {
+		k_mutex_unlock(&fifo_mutex);
+		return err;
+	}
+
+	acc = fifo_acc;
+	acc_reset(&fifo_acc);
+
+	k_mutex_unlock(&fifo_mutex);
+
+	if (acc.overruns) {
+		LOG_WRN("LIS2DH FIFO overran %u times, samples were lost", acc.overruns);
+	}
+
+	if (acc.count == 0) {
+		return -ENODATA;
+	}
+
+	acc_mean(&acc, window->mean);
+
+	for (int axis = 0; axis < 3; axis++) {
+		p2p = MAX(p2p, acc.max[axis] - acc.min[axis]);
+	}
+
+	window->p2p = mg_to_accel(p2p);
+	window->count = acc.count;
+	window->overruns = acc.overruns;
+
+	return acc.count;
+}
+
+int app_imu_fifo_sample(int32_t accel[3])
+{
+	struct fifo_acc acc;
+	int count;
+
+	if (!imu_dev) {
+		return -ENODEV;
+	}
+
+	acc_reset(&acc);
+
+	k_mutex_lock(&fifo_mutex, K_FOREVER);
+
+	count = fifo_read(&acc);
+	acc_merge(&fifo_acc, &acc);
+
+	k_mutex_unlock(&fifo_mutex);
+
+	if (count > 0) {
+		acc_mean(&acc, accel);
+	}
+
+	return count;
+}
+
+int app_imu_odr_set(uint16_t odr_hz)
+{
+	struct sensor_value odr = {.val1 = odr_hz};
+	int err;
+
+	if (!imu_dev) {
+		return -ENODEV;
+	}
+
+	err = sensor_attr_set(imu_dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &odr);
+	if (err) {
+		return err;
+	}
+
+	/* The FIFO fills at the new rate from now on */
+	k_mutex_lock(&fifo_mutex, K_FOREVER);
+	fifo_odr_hz = odr_hz;
+	k_work_reschedule(&fifo_poll_work, FIFO_POLL_DELAY(odr_hz));
+	k_mutex_unlock(&fifo_mutex);
+
+	return 0;
+}
+
+uint32_t app_imu_motion_count(void)
+{
+	return atomic_get(&motion_count);
+}
+
+#ifdef CONFIG_APP_IMU_MOTION
+
+static void motion_handler(const struct device *dev, const struct sensor_trigger *trig)
+{
+	static int64_t last_wake_ms = -MOTION_WAKE_HOLDOFF_MS;
+	int64_t now = k_uptime_get();
+
+	atomic_inc(&motion_count);
+
+	if (now - last_wake_ms >= MOTION_WAKE_HOLDOFF_MS) {
+		LOG_INF("Motion detected");
+		last_wake_ms = now;
+		app_sched_request(BIT(APP_TASK_IMU));
+	}
+}
+
+static int imu_motion_enable(const struct device *dev)
+{
+	static const struct sensor_trigger trig = {
+		.type = SENSOR_TRIG_DELTA,
+		.chan = SENSOR_CHAN_ACCEL_XYZ,
+	};
+	int64_t threshold_um_s2 = (int64_t)CONFIG_APP_IMU_MOTION_THRESHOLD_MG * SENSOR_G / 1000;
+	struct sensor_value val;
+	int err;
+
+	/* The driver takes the threshold in m/s^2 and the duration in samples */
+	sensor_value_from_micro(&val, threshold_um_s2);
+
+	err = sensor_attr_set(dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_SLOPE_TH, &val);
+	if (err) {
+		return err;
+	}
+
+	val.val1 = CONFIG_APP_IMU_MOTION_DURATION;
+	val.val2 = 0;
+
+	err = sensor_attr_set(dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_SLOPE_DUR, &val);
+	if (err) {
+		return err;
+	}
+
+	return sensor_trigger_set(dev, &trig, motion_handler);
+}
+
+#endif /* CONFIG_APP_IMU_MOTION */
+
+int app_imu_init(const struct device *dev)
+{
+	int err;
+
+	imu_dev = dev;
+	acc_reset(&fifo_acc);
+
+	err = app_imu_odr_set(CONFIG_APP_IMU_ODR_HZ);
+	if (err) {
+		LOG_WRN("Failed to set LIS2DH sampling rate: %d", err);
+	}
+
+	err = imu_read_format();
+	if (err) {
+		LOG_ERR("Failed to read LIS2DH configuration: %d", err);
+		return err;
+	}
+
+	err = imu_fifo_enable();
+	if (err) {
+		LOG_ERR("Failed to enable LIS2DH FIFO: %d", err);
+		k_work_cancel_delayable(&fifo_poll_work);
+		return err;
+	}
+
+	k_work_reschedule(&fifo_poll_work, FIFO_POLL_DELAY(fifo_odr_hz));
+
+	IF_ENABLED(CONFIG_APP_IMU_MOTION, (
+		err = imu_motion_enable(dev);
+		if (err) {
+			LOG_WRN("Motion interrupt not available: %d", err);
+		}
+	));
+
+	LOG_DBG("LIS2DH FIFO enabled (%u mg/digit, %d Hz)", sample_mg, CONFIG_APP_IMU_ODR_HZ);
+
+	return 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * LIS2DH accelerometer FIFO and motion interrupt.
+ *
+ * The Zephyr driver configures range and resolution, but only reads one
+ * sample at a time. Here the 32-entry hardware FIFO is put in stream mode, so
+ * the accelerometer keeps sampling at `CONFIG_APP_IMU_ODR_HZ` between loops
+ * while the MCU sleeps. Each loop drains the FIFO in a single I2C burst and
+ * reports the mean of the drained samples, which is a much steadier tilt
+ * estimate than a single snapshot, and the largest peak-to-peak swing of an
+ * axis, so a knock or tamper between loops is not averaged away.
+ *
+ * When the loop period is longer than the FIFO covers (32 samples), a work
+ * item reads the FIFO once it is 3/4 full and adds the samples to the next
+ * window, so none are lost. Overruns are still counted and logged.
+ *
+ * With `CONFIG_APP_IMU_MOTION` (which needs `CONFIG_LIS2DH_TRIGGER` and an
+ * interrupt line in the devicetree), movement above
+ * `CONFIG_APP_IMU_MOTION_THRESHOLD_MG` raises an interrupt that wakes the
+ * system thread, so a tilt or tamper event is sampled and uploaded right away
+ * instead of at the next loop.
+ */
+
+#ifndef __APP_IMU_H__
+#define __APP_IMU_H__
+
+#include <stdint.h>
+#include <zephyr/device.h>
+
+int app_imu_init(const struct device *dev);
+
+/** Summary of the samples read from the FIFO since the previous drain */
+struct app_imu_window {
+	/* Mean acceleration on X, Y and Z, in milli m/s^2 */
+	int32_t mean[3];
+	/* Largest difference between the highest and lowest sample of one axis */
+	int32_t p2p;
+	uint32_t count;
+	/* Times the FIFO was found full with its oldest samples overwritten */
+	uint32_t overruns;
+};
+
+/**
+ * Read every sample waiting in the FIFO and summarize them with those read by
+ * app_imu_fifo_sample() and the poll work since the last drain.
+ *
+ * @return number of samples summarized, -ENODATA if there were none or
+ * another negative error code
+ */
+int app_imu_fifo_drain(struct app_imu_window *window);
+
+/**
+ * Read the samples waiting in the FIFO without taking them from the next
+ * app_imu_fifo_drain(), for captures running alongside the loop.
+ *
+ * @param accel mean acceleration on X, Y and Z in milli m/s^2 of the samples read
+ *
+ * @return number of samples read, -ENODATA if the FIFO was empty or another
+ * negative error code
+ */
+int app_imu_fifo_sample(int32_t accel[3]);
+
+/** Change the sampling rate; the FIFO keeps its samples */
+int app_imu_odr_set(uint16_t odr_hz);
+
+/** Number of motion interrupts since boot */
+uint32_t app_imu_motion_count(void);
+
+#endif /* __APP_IMU_H__ */
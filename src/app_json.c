@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <zephyr/sys/printk.h>
+
+#include "app_json.h"
+
+int app_json_append(char *buf, size_t len, size_t *pos, const char *fmt, ...)
+{
+	va_list args;
+	int ret;
+
+	va_start(args, fmt);
+	ret = vsnprintk(&buf[*pos], len - *pos, fmt, args);
+	va_end(args);
+
+	if ((ret < 0) || (ret >= (len - *pos))) {
+		return -ENOMEM;
+	}
+
+	*pos += ret;
+	return 0;
+}
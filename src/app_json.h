@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Building JSON documents piecewise into a fixed buffer, shared by the
+ * LightDB State and Stream encoders.
+ */
+
+#ifndef __APP_JSON_H__
+#define __APP_JSON_H__
+
+#include <stddef.h>
+
+/**
+ * Append printf-style text at `*pos` and advance `*pos` past it.
+ *
+ * @return 0, or -ENOMEM if the text and its NUL do not fit in `len` bytes;
+ *         `*pos` is left unchanged then
+ */
+int app_json_append(char *buf, size_t len, size_t *pos, const char *fmt, ...);
+
+#endif /* __APP_JSON_H__ */
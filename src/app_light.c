@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_light, LOG_LEVEL_DBG);
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "app_light.h"
+#include "app_sched.h"
+
+#define APDS9960_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(avago_apds9960)
+
+/* APDS9960 registers used on top of the Zephyr driver */
+#define APDS9960_REG_ENABLE 0x80
+#define APDS9960_ENABLE_PON BIT(0)
+#define APDS9960_ENABLE_AEN BIT(1)
+#define APDS9960_ENABLE_PEN BIT(2)
+#define APDS9960_ENABLE_PIEN BIT(5)
+#define APDS9960_ENABLE_AIEN BIT(4)
+#define APDS9960_REG_AILTL 0x84
+#define APDS9960_REG_PERS 0x8C
+#define APDS9960_PERS_APERS_MASK BIT_MASK(4)
+#define APDS9960_REG_STATUS 0x93
+#define APDS9960_STATUS_AVALID BIT(0)
+#define APDS9960_REG_CDATAL 0x94
+#define APDS9960_REG_AICLEAR 0xE7
+
+/* Consecutive conversions out of range before the interrupt is raised */
+#define LIGHT_PERSISTENCE 2
+
+/* Do not wake the system thread more often than this */
+#define LIGHT_WAKE_HOLDOFF_MS 5000
+
+static const struct i2c_dt_spec light_i2c = I2C_DT_SPEC_GET(APDS9960_NODE);
+
+static int light_set_window(uint16_t low, uint16_t high)
+{
+	uint8_t buf[5];
+
+	/* AILTL, AILTH, AIHTL and AIHTH are consecutive */
+	buf[0] = APDS9960_REG_AILTL;
+	sys_put_le16(low, &buf[1]);
+	sys_put_le16(high, &buf[3]);
+
+	return i2c_write_dt(&light_i2c, buf, sizeof(buf));
+}
+
+/* Interrupt when the clear count leaves +/- CONFIG_APP_LIGHT_THRESHOLD_PCT of `clear` */
+static int light_set_thresholds(int32_t clear)
+{
+	int32_t band = MAX(clear * CONFIG_APP_LIGHT_THRESHOLD_PCT / 100,
+			   CONFIG_APP_LIGHT_THRESHOLD_MIN);
+
+	return light_set_window(MAX(clear - band, 0), MIN(clear + band, UINT16_MAX));
+}
+
+static void light_handler(const struct device *dev, const struct sensor_trigger *trig)
+{
+	static int64_t last_wake_ms = -LIGHT_WAKE_HOLDOFF_MS;
+	int64_t now = k_uptime_get();
+	int err;
+
+	/* Release the interrupt line; the next read moves the thresholds */
+	err = i2c_reg_write_byte_dt(&light_i2c, APDS9960_REG_AICLEAR, 0);
+	if (err) {
+		LOG_ERR("Failed to clear light interrupt: %d", err);
+	}
+
+	if (now - last_wake_ms >= LIGHT_WAKE_HOLDOFF_MS) {
+		LOG_INF("Light level changed");
+		last_wake_ms = now;
+		app_sched_request(BIT(APP_TASK_LIGHT));
+	}
+}
+
+int app_light_read(int32_t crgb[4])
+{
+	uint8_t buf[8];
+	uint8_t status;
+	int err;
+
+	err = i2c_reg_read_byte_dt(&light_i2c, APDS9960_REG_STATUS, &status);
+	if (err) {
+		return err;
+	}
+
+	if (!(status & APDS9960_STATUS_AVALID)) {
+		return -ENODATA;
+	}
+
+	err = i2c_burst_read_dt(&light_i2c, APDS9960_REG_CDATAL, buf, sizeof(buf));
+	if (err) {
+		return err;
+	}
+
+	for (int i = 0; i < 4; i++) {
+		crgb[i] = sys_get_le16(&buf[2 * i]);
+	}
+
+	err = light_set_thresholds(crgb[0]);
+	if (err) {
+		LOG_WRN("Failed to update light thresholds: %d", err);
+	}
+
+	return 0;
+}
+
+int app_light_init(const struct device *dev)
+{
+	/*
+	 * The driver only dispatches interrupts once a handler is registered, and
+	 * only supports the proximity threshold trigger, which also turns on the
+	 * proximity engine and its IR LED
+	 */
+	static const struct sensor_trigger trig = {
+		.type = SENSOR_TRIG_THRESHOLD,
+		.chan = SENSOR_CHAN_PROX,
+	};
+	int err;
+
+	err = sensor_trigger_set(dev, &trig, light_handler);
+	if (err) {
+		LOG_ERR("Failed to set light trigger: %d", err);
+		return err;
+	}
+
+	err = i2c_reg_update_byte_dt(&light_i2c, APDS9960_REG_PERS, APDS9960_PERS_APERS_MASK,
+				     LIGHT_PERSISTENCE);
+	if (err) {
+		return err;
+	}
+
+	/* No interrupt until the first reading sets the window */
+	err = light_set_window(0, UINT16_MAX);
+	if (err) {
+		return err;
+	}
+
+	/* Run ALS continuously and interrupt on ALS only; proximity stays off */
+	return i2c_reg_update_byte_dt(&light_i2c, APDS9960_REG_ENABLE,
+				      APDS9960_ENABLE_PON | APDS9960_ENABLE_AEN |
+					      APDS9960_ENABLE_PEN | APDS9960_ENABLE_AIEN |
+					      APDS9960_ENABLE_PIEN,
+				      APDS9960_ENABLE_PON | APDS9960_ENABLE_AEN |
+					      APDS9960_ENABLE_AIEN);
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * APDS9960 light sensor in continuous, interrupt-driven mode.
+ *
+ * The sensor converts ambient light continuously and latches the latest
+ * clear/red/green/blue counts, so a routine read is a single I2C burst with no
+ * waiting for a conversion. After every read the ALS interrupt thresholds are
+ * re-centered on the new clear value. A light change of more than
+ * `CONFIG_APP_LIGHT_THRESHOLD_PCT` raises the sensor's interrupt line, which
+ * wakes the system thread so the change is sampled and uploaded right away.
+ *
+ * The Zephyr driver (in trigger mode) owns the interrupt GPIO and calls back
+ * into this module; the ALS thresholds and interrupt enable are programmed
+ * here because the driver only exposes proximity thresholds.
+ */
+
+#ifndef __APP_LIGHT_H__
+#define __APP_LIGHT_H__
+
+#include <stdint.h>
+#include <zephyr/device.h>
+
+int app_light_init(const struct device *dev);
+
+/**
+ * Read the latest latched light values.
+ *
+ * @param crgb clear, red, green and blue counts
+ *
+ * @return 0, -ENODATA if no conversion has completed yet or another negative
+ * error code
+ */
+int app_light_read(int32_t crgb[4]);
+
+#endif /* __APP_LIGHT_H__ */
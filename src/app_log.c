@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_log, LOG_LEVEL_DBG);
+
+#include <string.h>
+#include <golioth/client.h>
+#include <golioth/stream.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log_backend.h>
+#include <zephyr/logging/log_ctrl.h>
+#include <zephyr/logging/log_output.h>
+#ifdef CONFIG_APP_LOG_FORMAT_DICTIONARY
+#include <zephyr/logging/log_output_dict.h>
+#endif
+#include <zcbor_encode.h>
+
+#include "app_log.h"
+#include "app_log_batch.h"
+
+/* Longest record; longer ones are dropped rather than cut */
+#define LOG_RECORD_MAX_LEN 256
+
+/*
+ * Worst case of a batch document besides its data: map header and break,
+ * "seq" and "fmt" (9 bytes each), "suppressed" (16) and "dropped" (13) with
+ * 32-bit values, and "data" with a string header of up to 3 bytes
+ */
+#define LOG_DOC_OVERHEAD (2 + 9 + 9 + 16 + 13 + 5 + 3)
+
+/* A document is uploaded in a single CoAP request, not blockwise */
+#define LOG_DOC_MAX_LEN CONFIG_GOLIOTH_BLOCKWISE_UPLOAD_MAX_BLOCK_SIZE
+
+BUILD_ASSERT(CONFIG_APP_LOG_BATCH_LEN + LOG_DOC_OVERHEAD <= LOG_DOC_MAX_LEN,
+	     "CONFIG_APP_LOG_BATCH_LEN leaves no room for the rest of the document");
+
+/* Nesting depth of a batch document: a single map */
+#define CBOR_LOG_DEPTH 1
+
+/* Errors are uploaded this soon instead of waiting for the batch to fill */
+#define LOG_ERR_FLUSH_S 1
+
+#ifdef CONFIG_APP_LOG_FORMAT_DICTIONARY
+#define LOG_FORMAT_NAME "dict"
+#else
+#define LOG_FORMAT_NAME "text"
+#endif
+
+#define RATE_INTERVAL_MS (60 * MSEC_PER_SEC / CONFIG_APP_LOG_RATE_PER_MIN)
+
+#define HOUR_MS (3600 * MSEC_PER_SEC)
+
+static struct golioth_client *client;
+static bool panic_mode;
+
+/* Record being formatted; only used by the log processing thread */
+static uint8_t record_buf[LOG_RECORD_MAX_LEN];
+static size_t record_len;
+static bool record_overflow;
+
+/* Staging buffer of the log output */
+static uint8_t output_buf[64];
+
+/* Batch waiting to be uploaded */
+static K_MUTEX_DEFINE(batch_lock);
+static uint8_t batch_buf[CONFIG_APP_LOG_BATCH_LEN];
+static struct app_log_batch batch = {
+	.buf = batch_buf,
+	.size = sizeof(batch_buf),
+};
+static uint32_t batch_seq;
+/* Left out since the last upload for being over the rate limit */
+static uint32_t suppressed;
+
+static uint8_t doc_buf[CONFIG_APP_LOG_BATCH_LEN + LOG_DOC_OVERHEAD];
+
+/* Uplink use since hour_start_ms */
+static int64_t hour_start_ms;
+static uint32_t hour_bytes;
+static uint32_t hour_records;
+static uint32_t hour_suppressed;
+
+/* Theoretical arrival time of the next record of each module, in ms */
+static int64_t rate_tat[CONFIG_APP_LOG_SOURCES_MAX];
+
+static void flush_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(flush_work, flush_work_handler);
+
+static int record_out(uint8_t *data, size_t length, void *ctx)
+{
+	if (length > sizeof(record_buf) - record_len) {
+		record_overflow = true;
+		return length;
+	}
+
+	memcpy(&record_buf[record_len], data, length);
+	record_len += length;
+
+	return length;
+}
+
+LOG_OUTPUT_DEFINE(log_output_app, record_out, output_buf, sizeof(output_buf));
+
+static int msg_source_id(struct log_msg *msg)
+{
+	const void *source = log_msg_get_source(msg);
+
+	if (source == NULL) {
+		return -1;
+	}
+
+	return IS_ENABLED(CONFIG_LOG_RUNTIME_FILTERING)
+		       ? log_dynamic_source_id((struct log_source_dynamic_data *)source)
+		       : log_const_source_id(source);
+}
+
+static bool rate_allow(int source_id, int64_t now_ms)
+{
+	if ((source_id < 0) || (source_id >= ARRAY_SIZE(rate_tat))) {
+		return true;
+	}
+
+	return app_log_rate_allow(&rate_tat[source_id], now_ms, RATE_INTERVAL_MS,
+				  CONFIG_APP_LOG_RATE_BURST);
+}
+
+/* Format `msg` into record_buf; return false if it does not fit */
+static bool record_format(struct log_msg *msg)
+{
+	record_len = 0;
+	record_overflow = false;
+
+#ifdef CONFIG_APP_LOG_FORMAT_DICTIONARY
+	log_dict_output_msg_process(&log_output_app, msg, 0);
+#else
+	log_output_msg_process(&log_output_app, msg,
+			       LOG_OUTPUT_FLAG_LEVEL | LOG_OUTPUT_FLAG_TIMESTAMP |
+				       LOG_OUTPUT_FLAG_CRLF_LFONLY);
+#endif
+	log_output_flush(&log_output_app);
+
+	return !record_overflow;
+}
+
+static int encode_batch(uint8_t *buf, size_t len)
+{
+	ZCBOR_STATE_E(zse, CBOR_LOG_DEPTH, buf, len, 1);
+	bool ok;
+
+	ok = zcbor_map_start_encode(zse, 5) && zcbor_tstr_put_lit(zse, "seq") &&
+	     zcbor_uint32_put(zse, batch_seq) && zcbor_tstr_put_lit(zse, "fmt") &&
+	     zcbor_tstr_put_lit(zse, LOG_FORMAT_NAME);
+
+	if (ok && suppressed) {
+		ok = zcbor_tstr_put_lit(zse, "suppressed") && zcbor_uint32_put(zse, suppressed);
+	}
+	if (ok && batch.dropped) {
+		ok = zcbor_tstr_put_lit(zse, "dropped") && zcbor_uint32_put(zse, batch.dropped);
+	}
+
+	/* Dictionary records are binary; text records are lines */
+	ok = ok && zcbor_tstr_put_lit(zse, "data") &&
+	     COND_CODE_1(CONFIG_APP_LOG_FORMAT_DICTIONARY,
+			 (zcbor_bstr_encode_ptr(zse, batch.buf, batch.len)),
+			 (zcbor_tstr_encode_ptr(zse, (const char *)batch.buf, batch.len))) &&
+	     zcbor_map_end_encode(zse, 5);
+	if (!ok) {
+		return -ENOMEM;
+	}
+
+	return zse->payload - buf;
+}
+
+/*
+ * Upload the batch and start a new one; call with batch_lock held, from the
+ * flush work only: the log processing thread has a small stack and must not
+ * enter the Golioth client
+ */
+static int batch_upload(void)
+{
+	int err;
+	int len;
+
+	if (batch.records == 0) {
+		return 0;
+	}
+
+	if (!client || !golioth_client_is_connected(client)) {
+		return -ENOTCONN;
+	}
+
+	len = encode_batch(doc_buf, sizeof(doc_buf));
+	if (len < 0) {
+		/* Would fail again: count the records as lost instead of holding them */
+		batch.dropped += batch.records;
+		batch.len = 0;
+		batch.records = 0;
+		return len;
+	}
+
+	/*
+	 * No callback: logging the outcome of a log upload would feed the next
+	 * batch. The payload is copied, so doc_buf may be reused right away.
+	 */
+	err = golioth_stream_set_async(client, "logs", GOLIOTH_CONTENT_TYPE_CBOR, doc_buf, len,
+				       NULL, NULL);
+	if (err) {
+		return -EIO;
+	}
+
+	hour_bytes += len;
+	hour_records += batch.records;
+
+	batch_seq++;
+	app_log_batch_reset(&batch);
+	suppressed = 0;
+
+	return 0;
+}
+
+static void process(const struct log_backend *const backend, union log_msg_generic *msg)
+{
+	uint8_t level = log_msg_get_level(&msg->log);
+
+	if (panic_mode) {
+		return;
+	}
+
+	k_mutex_lock(&batch_lock, K_FOREVER);
+
+	if ((level != LOG_LEVEL_ERR) && !rate_allow(msg_source_id(&msg->log), k_uptime_get())) {
+		suppressed++;
+		hour_suppressed++;
+		goto out;
+	}
+
+	if (!record_format(&msg->log)) {
+		batch.dropped++;
+		goto out;
+	}
+
+	if (app_log_batch_add(&batch, record_buf, record_len,
+			      client && golioth_client_is_connected(client))) {
+		k_work_reschedule(&flush_work, K_NO_WAIT);
+	} else if (level == LOG_LEVEL_ERR) {
+		k_work_reschedule(&flush_work, K_SECONDS(LOG_ERR_FLUSH_S));
+	} else {
+		/* No effect if an upload is already scheduled */
+		k_work_schedule(&flush_work, K_SECONDS(CONFIG_APP_LOG_FLUSH_S));
+	}
+
+out:
+	k_mutex_unlock(&batch_lock);
+}
+
+static void dropped_cb(const struct log_backend *const backend, uint32_t cnt)
+{
+	k_mutex_lock(&batch_lock, K_FOREVER);
+	batch.dropped += cnt;
+	k_mutex_unlock(&batch_lock);
+}
+
+static void panic(const struct log_backend *const backend)
+{
+	/* Nothing can be uploaded from here on */
+	panic_mode = true;
+}
+
+static const struct log_backend_api log_backend_app_api = {
+	.process = process,
+	.dropped = dropped_cb,
+	.panic = panic,
+};
+
+LOG_BACKEND_DEFINE(log_backend_app, log_backend_app_api, false);
+
+static void flush_work_handler(struct k_work *work)
+{
+	int64_t now = k_uptime_get();
+	uint32_t bytes = 0;
+	uint32_t records = 0;
+	uint32_t skipped = 0;
+	bool hour_over;
+	int err;
+
+	k_mutex_lock(&batch_lock, K_FOREVER);
+
+	err = batch_upload();
+	if (err == -ENOTCONN) {
+		/* Kept until the connection is back or the batch is full */
+		k_work_schedule(&flush_work, K_SECONDS(CONFIG_APP_LOG_FLUSH_S));
+	}
+
+	hour_over = (now - hour_start_ms >= HOUR_MS);
+	if (hour_over) {
+		bytes = hour_bytes;
+		records = hour_records;
+		skipped = hour_suppressed;
+
+		hour_start_ms = now;
+		hour_bytes = 0;
+		hour_records = 0;
+		hour_suppressed = 0;
+	}
+
+	k_mutex_unlock(&batch_lock);
+
+	if (hour_over) {
+		LOG_INF("Log uplink in the last hour: %u bytes, %u records, %u rate limited", bytes,
+			records, skipped);
+	}
+}
+
+void app_log_set_client(struct golioth_client *log_client)
+{
+	client = log_client;
+}
+
+static int app_log_init(void)
+{
+	/* Modules log at DBG on the console but only ship at the configured level */
+	log_backend_enable(&log_backend_app, NULL, CONFIG_APP_LOG_SHIP_LEVEL);
+
+	return 0;
+}
+
+SYS_INIT(app_log_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
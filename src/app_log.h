@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Log shipping over LightDB Stream, in place of the Golioth log backend.
+ *
+ * The Golioth log backend sends every record as its own CoAP message. This
+ * backend keeps the records in a batch of `CONFIG_APP_LOG_BATCH_LEN` bytes
+ * and uploads the batch to the `logs` stream path when it is full, or
+ * `CONFIG_APP_LOG_FLUSH_S` after its first record. Errors are uploaded within
+ * a second.
+ *
+ * Records are shipped up to `CONFIG_APP_LOG_SHIP_LEVEL` (info by default) so
+ * the debug output of the sensor loop stays on the console unless its level
+ * is raised with the `set_log_level` RPC. Each module may ship
+ * `CONFIG_APP_LOG_RATE_PER_MIN` records per minute on average, with bursts of
+ * `CONFIG_APP_LOG_RATE_BURST`; records over the limit, except errors, are
+ * counted and left out.
+ *
+ * With `CONFIG_APP_LOG_FORMAT_DICTIONARY`, records are in the binary format
+ * of Zephyr dictionary logging: the format strings stay in the build's
+ * `log_dictionary.json` and only their addresses and arguments are sent. The
+ * uplink bytes of the last hour are logged every hour.
+ */
+
+#ifndef __APP_LOG_H__
+#define __APP_LOG_H__
+
+#include <golioth/client.h>
+
+#ifdef CONFIG_APP_LOG_SHIPPING
+
+void app_log_set_client(struct golioth_client *log_client);
+
+#else
+
+static inline void app_log_set_client(struct golioth_client *log_client)
+{
+}
+
+#endif /* CONFIG_APP_LOG_SHIPPING */
+
+#endif /* __APP_LOG_H__ */
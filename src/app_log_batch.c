@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <zephyr/sys/util.h>
+
+#include "app_log_batch.h"
+
+bool app_log_rate_allow(int64_t *tat, int64_t now_ms, int64_t interval_ms, uint32_t burst)
+{
+	if (*tat - now_ms > (int64_t)(burst - 1) * interval_ms) {
+		return false;
+	}
+
+	*tat = MAX(*tat, now_ms) + interval_ms;
+
+	return true;
+}
+
+bool app_log_batch_add(struct app_log_batch *batch, const uint8_t *record, size_t len,
+		       bool connected)
+{
+	if (len > batch->size) {
+		batch->dropped++;
+		return false;
+	}
+
+	if (batch->len + len > batch->size) {
+		if (connected) {
+			batch->dropped++;
+			return true;
+		}
+
+		/* Offline for too long: make room for the most recent records */
+		batch->dropped += batch->records;
+		batch->len = 0;
+		batch->records = 0;
+	}
+
+	memcpy(&batch->buf[batch->len], record, len);
+	batch->len += len;
+	batch->records++;
+
+	return batch->size - batch->len < len;
+}
+
+void app_log_batch_reset(struct app_log_batch *batch)
+{
+	batch->len = 0;
+	batch->records = 0;
+	batch->dropped = 0;
+}
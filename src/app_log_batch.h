@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Rate limiting and batching of shipped log records (see app_log.h).
+ *
+ * Kept apart from the log backend, which owns the state and the locking, so
+ * that the policy can be tested on its own.
+ */
+
+#ifndef __APP_LOG_BATCH_H__
+#define __APP_LOG_BATCH_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Rate limit of one log module as a generic cell rate algorithm: `*tat`, the
+ * theoretical arrival time of the next record, moves `interval_ms` further
+ * with every record allowed. Up to `burst` records are allowed at once after
+ * a quiet period.
+ *
+ * @return whether a record at `now_ms` is within the limit
+ */
+bool app_log_rate_allow(int64_t *tat, int64_t now_ms, int64_t interval_ms, uint32_t burst);
+
+struct app_log_batch {
+	uint8_t *buf;
+	size_t size;
+	size_t len;
+	uint32_t records;
+	/* Records lost since the last upload */
+	uint32_t dropped;
+};
+
+/**
+ * Append a record to the batch. When the record does not fit, it is dropped
+ * while `connected`, as the batch is about to be uploaded; offline, the batch
+ * is discarded to make room for the most recent records.
+ *
+ * @return whether the batch should be uploaded now: a record as long as this
+ *         one would not fit anymore, or this one did not fit
+ */
+bool app_log_batch_add(struct app_log_batch *batch, const uint8_t *record, size_t len,
+		       bool connected);
+
+/** Start a new batch, once the previous one has been uploaded or given up */
+void app_log_batch_reset(struct app_log_batch *batch);
+
+#endif /* __APP_LOG_BATCH_H__ */
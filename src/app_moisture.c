@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "app_moisture.h"
+
+/* Moisture level for every ADC code. The sensor loop is the only caller of
+ * both moisture_classifier_build() and moisture_classify(), and rebuilds the
+ * table before classifying when it picks up a new settings snapshot, so a
+ * lookup never sees a partly rebuilt table.
+ */
+static uint8_t moisture_lut[MOISTURE_ADC_MAX + 1];
+
+void moisture_filter_reset(struct moisture_filter *filter)
+{
+	filter->ema = 0;
+	filter->primed = false;
+}
+
+static void sort_u16(uint16_t *samples, size_t count)
+{
+	/* Insertion sort; bursts are short and usually nearly sorted */
+	for (size_t i = 1; i < count; i++) {
+		uint16_t v = samples[i];
+		size_t j = i;
+
+		while ((j > 0) && (samples[j - 1] > v)) {
+			samples[j] = samples[j - 1];
+			j--;
+		}
+		samples[j] = v;
+	}
+}
+
+uint16_t moisture_burst_reduce(uint16_t *samples, size_t count, size_t trim)
+{
+	uint32_t sum = 0;
+	size_t kept;
+
+	if (count == 0) {
+		return 0;
+	}
+
+	sort_u16(samples, count);
+
+	/* Keep at least one (odd count) or two (even count) middle values */
+	if (trim > (count - 1) / 2) {
+		trim = (count - 1) / 2;
+	}
+
+	kept = count - (2 * trim);
+
+	for (size_t i = trim; i < (count - trim); i++) {
+		sum += samples[i];
+	}
+
+	return (sum + (kept / 2)) / kept;
+}
+
+uint16_t moisture_filter_update(struct moisture_filter *filter, uint16_t value, uint8_t shift)
+{
+	int32_t sample = (int32_t)value << MOISTURE_EMA_FRAC_BITS;
+
+	if (!filter->primed || (shift == 0)) {
+		filter->ema = sample;
+		filter->primed = true;
+	} else {
+		int32_t diff = sample - filter->ema;
+		int32_t half = 1 << (shift - 1);
+
+		/*
+		 * Round the step to nearest in both directions; truncating it
+		 * would leave the output up to a count short of a steady input.
+		 */
+		filter->ema += (diff >= 0) ? ((diff + half) >> shift) : -((half - diff) >> shift);
+	}
+
+	return (filter->ema + (1 << (MOISTURE_EMA_FRAC_BITS - 1))) >> MOISTURE_EMA_FRAC_BITS;
+}
+
+static void sort_bands_desc(struct moisture_band *bands, size_t count)
+{
+	for (size_t i = 1; i < count; i++) {
+		struct moisture_band b = bands[i];
+		size_t j = i;
+
+		while ((j > 0) && (bands[j - 1].threshold < b.threshold)) {
+			bands[j] = bands[j - 1];
+			j--;
+		}
+		bands[j] = b;
+	}
+}
+
+void moisture_classifier_build(struct moisture_band *bands, size_t count, uint8_t wet_level)
+{
+	size_t b = 0;
+
+	sort_bands_desc(bands, count);
+
+	/* Walk down the ADC range, stepping to the next band at each threshold */
+	for (int32_t code = MOISTURE_ADC_MAX; code >= 0; code--) {
+		while ((b < count) && (code < bands[b].threshold)) {
+			b++;
+		}
+
+		moisture_lut[code] = (b < count) ? bands[b].level : wet_level;
+	}
+}
+
+uint8_t moisture_classify(uint16_t reading)
+{
+	return moisture_lut[reading & MOISTURE_ADC_MAX];
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Signal processing for the MCP3221 moisture probe ADC.
+ *
+ * Each loop reads a burst of `CONFIG_APP_MOISTURE_OVERSAMPLE` back-to-back
+ * conversions. The burst is reduced to one value with a median or trimmed mean
+ * (rejecting electrode spikes) and then smoothed across loops with an
+ * exponential moving average. All arithmetic is integer/fixed point.
+ *
+ * The filtered reading is classified into a moisture level with a lookup table
+ * holding one entry per 12-bit ADC code. The table is rebuilt from a list of
+ * thresholds only when those change, so classifying a sample is a single load.
+ */
+
+#ifndef __APP_MOISTURE_H__
+#define __APP_MOISTURE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* I2C address of the MCP3221 */
+#define MCP3221_I2C_ADDR 0x4D
+
+/* Full scale of the 12-bit MCP3221 */
+#define MOISTURE_ADC_MAX 4095
+
+/* Fractional bits kept in the EMA accumulator */
+#define MOISTURE_EMA_FRAC_BITS 8
+
+struct moisture_filter {
+	/* Filtered value in Q(MOISTURE_EMA_FRAC_BITS) */
+	int32_t ema;
+	bool primed;
+};
+
+void moisture_filter_reset(struct moisture_filter *filter);
+
+/**
+ * Reduce a burst of conversions to a single value.
+ *
+ * @param samples Conversions; sorted in place
+ * @param count Number of conversions
+ * @param trim Conversions discarded at each end before averaging. A value of
+ *             `(count - 1) / 2` or more yields the median.
+ */
+uint16_t moisture_burst_reduce(uint16_t *samples, size_t count, size_t trim);
+
+/**
+ * Feed one reduced value into the EMA stage and return the filtered value.
+ *
+ * @param shift EMA weight of the new value is 1/2^shift; 0 disables smoothing
+ */
+uint16_t moisture_filter_update(struct moisture_filter *filter, uint16_t value, uint8_t shift);
+
+/**
+ * One moisture band. The probe reads higher counts when drier, so a reading
+ * belongs to the band with the highest threshold it reaches.
+ */
+struct moisture_band {
+	/* Lowest ADC reading (inclusive) classified into this band */
+	int32_t threshold;
+	/* Moisture level reported for this band */
+	uint8_t level;
+};
+
+/**
+ * Rebuild the classification table.
+ *
+ * @param bands Bands in any order; sorted in place by descending threshold
+ * @param count Number of bands
+ * @param wet_level Level reported for readings below every threshold
+ */
+void moisture_classifier_build(struct moisture_band *bands, size_t count, uint8_t wet_level);
+
+/** Classify a filtered ADC reading using the table built last */
+uint8_t moisture_classify(uint16_t reading);
+
+#endif /* __APP_MOISTURE_H__ */
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_prof, LOG_LEVEL_DBG);
+
+#include <string.h>
+#include <zephyr/spinlock.h>
+
+#include "app_prof.h"
+
+/* Bucket n counts durations below 2^n us; the last one also counts longer ones */
+#define PROF_BUCKETS 24
+
+struct prof_hist {
+	uint32_t count;
+	uint32_t min_us;
+	uint32_t max_us;
+	uint32_t buckets[PROF_BUCKETS];
+};
+
+struct prof_summary {
+	uint32_t count;
+	uint32_t min_us;
+	uint32_t max_us;
+	uint32_t p50_us;
+	uint32_t p99_us;
+};
+
+/* Indexed by enum app_prof_stage; also the keys of the RPC response */
+static const char *const stage_names[APP_PROF_STAGE_COUNT] = {
+	[APP_PROF_CYCLE] = "cycle",
+	[APP_PROF_ACQ] = "acquisition",
+	[APP_PROF_READ + APP_TASK_MOISTURE] = "read_moisture",
+	[APP_PROF_READ + APP_TASK_LIGHT] = "read_light",
+	[APP_PROF_READ + APP_TASK_WEATHER] = "read_weather",
+	[APP_PROF_READ + APP_TASK_IMU] = "read_imu",
+	[APP_PROF_READ + APP_TASK_BATTERY] = "read_battery",
+	[APP_PROF_MOISTURE_FILTER] = "moisture_filter",
+	[APP_PROF_VWC] = "vwc",
+	[APP_PROF_ENQUEUE] = "enqueue",
+	[APP_PROF_ENCODE] = "encode",
+	[APP_PROF_DISPLAY] = "display",
+	[APP_PROF_STATE_PARSE] = "state_parse",
+	[APP_PROF_STATE_ENCODE] = "state_encode",
+};
+
+static struct k_spinlock prof_lock;
+static struct prof_hist hists[APP_PROF_STAGE_COUNT];
+
+static int bucket_of(uint32_t us)
+{
+	int bucket = (us == 0) ? 0 : (32 - __builtin_clz(us));
+
+	return MIN(bucket, PROF_BUCKETS - 1);
+}
+
+/* Upper bound of the bucket holding the given rank, clamped to what was seen */
+static uint32_t hist_percentile(const struct prof_hist *hist, uint32_t pct)
+{
+	uint32_t rank = DIV_ROUND_UP(hist->count * pct, 100);
+	uint32_t seen = 0;
+
+	for (int i = 0; i < PROF_BUCKETS; i++) {
+		seen += hist->buckets[i];
+		if (seen >= rank) {
+			return CLAMP((uint32_t)BIT(i), hist->min_us, hist->max_us);
+		}
+	}
+
+	return hist->max_us;
+}
+
+void app_prof_record(enum app_prof_stage stage, uint32_t start)
+{
+	uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+	struct prof_hist *hist = &hists[stage];
+	k_spinlock_key_t key = k_spin_lock(&prof_lock);
+
+	if ((hist->count == 0) || (us < hist->min_us)) {
+		hist->min_us = us;
+	}
+	hist->max_us = MAX(hist->max_us, us);
+	hist->buckets[bucket_of(us)]++;
+	hist->count++;
+
+	k_spin_unlock(&prof_lock, key);
+}
+
+bool app_prof_dump(zcbor_state_t *map)
+{
+	struct prof_summary sum;
+	k_spinlock_key_t key;
+	bool ok = true;
+
+	for (int i = 0; ok && (i < APP_PROF_STAGE_COUNT); i++) {
+		struct prof_hist *hist = &hists[i];
+
+		key = k_spin_lock(&prof_lock);
+		sum.count = hist->count;
+		if (sum.count) {
+			sum.min_us = hist->min_us;
+			sum.max_us = hist->max_us;
+			sum.p50_us = hist_percentile(hist, 50);
+			sum.p99_us = hist_percentile(hist, 99);
+			memset(hist, 0, sizeof(*hist));
+		}
+		k_spin_unlock(&prof_lock, key);
+
+		if (sum.count == 0) {
+			continue;
+		}
+
+		ok = zcbor_tstr_encode_ptr(map, stage_names[i], strlen(stage_names[i])) &&
+		     zcbor_map_start_encode(map, 5) &&
+		     zcbor_tstr_put_lit(map, "n") && zcbor_uint32_put(map, sum.count) &&
+		     zcbor_tstr_put_lit(map, "min_us") && zcbor_uint32_put(map, sum.min_us) &&
+		     zcbor_tstr_put_lit(map, "max_us") && zcbor_uint32_put(map, sum.max_us) &&
+		     zcbor_tstr_put_lit(map, "p50_us") && zcbor_uint32_put(map, sum.p50_us) &&
+		     zcbor_tstr_put_lit(map, "p99_us") && zcbor_uint32_put(map, sum.p99_us) &&
+		     zcbor_map_end_encode(map, 5);
+
+		LOG_DBG("%s: n=%u min=%u p50=%u p99=%u max=%u us", stage_names[i], sum.count,
+			sum.min_us, sum.p50_us, sum.p99_us, sum.max_us);
+	}
+
+	return ok;
+}
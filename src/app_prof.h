@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Stage profiling of the sensor loop and of LightDB State payloads.
+ *
+ * With `CONFIG_APP_PROF`, the duration of each stage of a sensor cycle is
+ * added to a histogram of power-of-two microsecond buckets in static memory.
+ * The `get_profile` RPC (see app_rpc.h) returns the count, min, max, p50 and
+ * p99 of every stage and starts a new measurement period. Percentiles are the
+ * upper bound of their bucket, so they are within a factor of two.
+ *
+ * Durations are taken with `k_cycle_get_32()`. They are wall-clock times:
+ * stages that wait on a bus or a conversion include the wait, which the DWT
+ * cycle counter would miss as it stops while the CPU sleeps.
+ *
+ * Without `CONFIG_APP_PROF` the calls below compile to nothing.
+ */
+
+#ifndef __APP_PROF_H__
+#define __APP_PROF_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zcbor_encode.h>
+#include <zephyr/kernel.h>
+
+#include "app_sched.h"
+
+enum app_prof_stage {
+	/* One app_sensors_read_and_stream() call */
+	APP_PROF_CYCLE,
+	/* Start of the first device read to completion of the last */
+	APP_PROF_ACQ,
+	/* One device read, from queueing to completion; indexed by enum app_task */
+	APP_PROF_READ,
+	APP_PROF_READ_LAST = APP_PROF_READ + APP_TASK_COUNT - 1,
+	/* Moisture burst reduction and filter */
+	APP_PROF_MOISTURE_FILTER,
+	/* Conversion of the filtered moisture reading to VWC */
+	APP_PROF_VWC,
+	/* Handing a sample to the stream buffer or the statistics window */
+	APP_PROF_ENQUEUE,
+	/* Encoding one stream batch */
+	APP_PROF_ENCODE,
+	/* Writing one Ostentus slide */
+	APP_PROF_DISPLAY,
+	/* Parsing one desired LightDB State payload */
+	APP_PROF_STATE_PARSE,
+	/* Encoding one LightDB State write */
+	APP_PROF_STATE_ENCODE,
+	APP_PROF_STAGE_COUNT
+};
+
+#ifdef CONFIG_APP_PROF
+
+static inline uint32_t app_prof_start(void)
+{
+	return k_cycle_get_32();
+}
+
+/** Add the time elapsed since `start`, from app_prof_start(), to `stage` */
+void app_prof_record(enum app_prof_stage stage, uint32_t start);
+
+/**
+ * Add a summary of every stage measured since the last call to an open zcbor
+ * map, then reset the histograms.
+ */
+bool app_prof_dump(zcbor_state_t *map);
+
+#else
+
+static inline uint32_t app_prof_start(void)
+{
+	return 0;
+}
+
+static inline void app_prof_record(enum app_prof_stage stage, uint32_t start)
+{
+}
+
+#endif /* CONFIG_APP_PROF */
+
+#endif /* __APP_PROF_H__ */
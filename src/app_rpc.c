@@ -7,6 +7,7 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(app_rpc, LOG_LEVEL_DBG);
 
+#include <string.h>
 #include <golioth/client.h>
 #include <golioth/rpc.h>
 #include <zephyr/logging/log_ctrl.h>
@@ -16,6 +17,10 @@ LOG_MODULE_REGISTER(app_rpc, LOG_LEVEL_DBG);
 #include <network_info.h>
 #endif
 
+#include "app_boot.h"
+#include "app_burst.h"
+#include "app_history.h"
+#include "app_prof.h"
 #include "app_rpc.h"
 
 static void reboot_work_handler(struct k_work *work)
@@ -43,10 +48,176 @@ static enum golioth_rpc_status on_get_network_info(zcbor_state_t *request_params
 		    (return GOLIOTH_RPC_UNIMPLEMENTED););
 }
 
+static enum golioth_rpc_status on_get_boot_timeline(zcbor_state_t *request_params_array,
+						    zcbor_state_t *response_detail_map,
+						    void *callback_arg)
+{
+	if (!app_boot_add_to_map(response_detail_map)) {
+		LOG_ERR("Failed to encode boot timeline");
+		return GOLIOTH_RPC_RESOURCE_EXHAUSTED;
+	}
+
+	return GOLIOTH_RPC_OK;
+}
+
+static enum golioth_rpc_status on_get_profile(zcbor_state_t *request_params_array,
+					      zcbor_state_t *response_detail_map,
+					      void *callback_arg)
+{
+#ifdef CONFIG_APP_PROF
+	if (!app_prof_dump(response_detail_map)) {
+		LOG_ERR("Failed to encode profile");
+		return GOLIOTH_RPC_RESOURCE_EXHAUSTED;
+	}
+
+	return GOLIOTH_RPC_OK;
+#else
+	return GOLIOTH_RPC_UNIMPLEMENTED;
+#endif
+}
+
+/* Integer parameter, which the console may send as a float */
+static bool rpc_int64_decode(zcbor_state_t *params, int64_t *value)
+{
+	double fvalue;
+
+	if (zcbor_int64_decode(params, value)) {
+		return true;
+	}
+
+	if (!zcbor_float_decode(params, &fvalue)) {
+		return false;
+	}
+
+	*value = (int64_t)fvalue;
+
+	return true;
+}
+
+static enum golioth_rpc_status on_get_history(zcbor_state_t *request_params_array,
+					      zcbor_state_t *response_detail_map,
+					      void *callback_arg)
+{
+	struct zcbor_string tier;
+	int64_t from_s = 0;
+	int64_t to_s = INT64_MAX;
+	int64_t cursor = 0;
+	bool ok;
+	int err;
+
+	/* [tier, from, to, cursor]; all but the tier may be left out */
+	ok = zcbor_tstr_decode(request_params_array, &tier);
+	if (ok && !zcbor_array_at_end(request_params_array)) {
+		ok = rpc_int64_decode(request_params_array, &from_s);
+	}
+	if (ok && !zcbor_array_at_end(request_params_array)) {
+		ok = rpc_int64_decode(request_params_array, &to_s);
+	}
+	if (ok && !zcbor_array_at_end(request_params_array)) {
+		ok = rpc_int64_decode(request_params_array, &cursor);
+	}
+	if (!ok || (cursor < 0) || (cursor > UINT32_MAX)) {
+		LOG_ERR("Failed to decode history parameters");
+		return GOLIOTH_RPC_INVALID_ARGUMENT;
+	}
+
+	err = app_history_query(response_detail_map, tier.value, tier.len, from_s, to_s, cursor);
+	switch (err) {
+	case 0:
+		return GOLIOTH_RPC_OK;
+	case -EINVAL:
+		LOG_ERR("Unknown history tier: %.*s", (int)tier.len, tier.value);
+		return GOLIOTH_RPC_INVALID_ARGUMENT;
+	case -ERANGE:
+		LOG_ERR("History cursor out of range: %lld", cursor);
+		return GOLIOTH_RPC_INVALID_ARGUMENT;
+	case -ENOTSUP:
+		return GOLIOTH_RPC_UNIMPLEMENTED;
+	default:
+		LOG_ERR("Failed to encode history: %d", err);
+		return GOLIOTH_RPC_RESOURCE_EXHAUSTED;
+	}
+}
+
+static enum golioth_rpc_status on_capture_burst(zcbor_state_t *request_params_array,
+						zcbor_state_t *response_detail_map,
+						void *callback_arg)
+{
+#ifdef CONFIG_APP_BURST
+	int64_t duration_s = CONFIG_APP_BURST_DURATION_S;
+	int err;
+
+	/* [duration_s]; the duration may be left out */
+	if (!zcbor_array_at_end(request_params_array) &&
+	    !rpc_int64_decode(request_params_array, &duration_s)) {
+		LOG_ERR("Failed to decode burst duration");
+		return GOLIOTH_RPC_INVALID_ARGUMENT;
+	}
+
+	if ((duration_s < 1) || (duration_s > CONFIG_APP_BURST_DURATION_MAX_S)) {
+		LOG_ERR("Burst duration out of range: %lld", duration_s);
+		return GOLIOTH_RPC_INVALID_ARGUMENT;
+	}
+
+	err = app_burst_start(duration_s);
+	if (err) {
+		LOG_WRN("Unable to start burst: %d", err);
+		return GOLIOTH_RPC_UNAVAILABLE;
+	}
+
+	/* The capture is uploaded to LightDB Stream once it is over */
+	if (!zcbor_tstr_put_lit(response_detail_map, "duration_s") ||
+	    !zcbor_uint32_put(response_detail_map, duration_s) ||
+	    !zcbor_tstr_put_lit(response_detail_map, "rate_hz") ||
+	    !zcbor_uint32_put(response_detail_map, CONFIG_APP_BURST_RATE_HZ)) {
+		return GOLIOTH_RPC_RESOURCE_EXHAUSTED;
+	}
+
+	return GOLIOTH_RPC_OK;
+#else
+	return GOLIOTH_RPC_UNIMPLEMENTED;
+#endif
+}
+
+/* Module names accepted by one set_log_level call */
+#define LOG_MODULES_MAX 8
+
+/* `pattern` is a module name, or a prefix followed by `*` */
+static bool log_module_match(const char *name, const struct zcbor_string *pattern)
+{
+	size_t len = pattern->len;
+
+	if ((len > 0) && (pattern->value[len - 1] == '*')) {
+		return strncmp(name, (const char *)pattern->value, len - 1) == 0;
+	}
+
+	return (strlen(name) == len) && (strncmp(name, (const char *)pattern->value, len) == 0);
+}
+
+/* Every module is selected when no names are given */
+static bool log_module_selected(const char *name, const struct zcbor_string *modules,
+				size_t num_modules)
+{
+	if (num_modules == 0) {
+		return true;
+	}
+
+	for (size_t i = 0; i < num_modules; i++) {
+		if (log_module_match(name, &modules[i])) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 static enum golioth_rpc_status on_set_log_level(zcbor_state_t *request_params_array,
 						zcbor_state_t *response_detail_map,
 						void *callback_arg)
 {
+	struct zcbor_string modules[LOG_MODULES_MAX];
+	size_t num_modules = 0;
+	int num_set = 0;
 	double param_0;
 	uint8_t log_level;
 	bool ok;
@@ -67,6 +238,16 @@ static enum golioth_rpc_status on_set_log_level(zcbor_state_t *request_params_ar
 		return GOLIOTH_RPC_INVALID_ARGUMENT;
 	}
 
+	/* Optional module names after the level; all modules when there are none */
+	while (!zcbor_array_at_end(request_params_array)) {
+		if ((num_modules == ARRAY_SIZE(modules)) ||
+		    !zcbor_tstr_decode(request_params_array, &modules[num_modules])) {
+			LOG_ERR("Failed to decode module names");
+			return GOLIOTH_RPC_INVALID_ARGUMENT;
+		}
+		num_modules++;
+	}
+
 	int source_id = 0;
 	char *source_name;
 
@@ -76,14 +257,22 @@ static enum golioth_rpc_status on_set_log_level(zcbor_state_t *request_params_ar
 			break;
 		}
 
-		log_filter_set(NULL, 0, source_id, log_level);
+		if (log_module_selected(source_name, modules, num_modules)) {
+			log_filter_set(NULL, 0, source_id, log_level);
+			++num_set;
+		}
 		++source_id;
 	}
 
-	LOG_WRN("Log levels for %d modules set to: %d", source_id, log_level);
+	if (num_set == 0) {
+		LOG_ERR("No log module matches");
+		return GOLIOTH_RPC_INVALID_ARGUMENT;
+	}
+
+	LOG_WRN("Log levels for %d modules set to: %d", num_set, log_level);
 
 	ok = zcbor_tstr_put_lit(response_detail_map, "log_modules") &&
-	     zcbor_float64_put(response_detail_map, (double)source_id);
+	     zcbor_float64_put(response_detail_map, (double)num_set);
 
 	return GOLIOTH_RPC_OK;
 }
@@ -113,6 +302,18 @@ void app_rpc_register(struct golioth_client *client)
 	err = golioth_rpc_register(rpc, "get_network_info", on_get_network_info, NULL);
 	rpc_log_if_register_failure(err);
 
+	err = golioth_rpc_register(rpc, "get_boot_timeline", on_get_boot_timeline, NULL);
+	rpc_log_if_register_failure(err);
+
+	err = golioth_rpc_register(rpc, "get_profile", on_get_profile, NULL);
+	rpc_log_if_register_failure(err);
+
+	err = golioth_rpc_register(rpc, "get_history", on_get_history, NULL);
+	rpc_log_if_register_failure(err);
+
+	err = golioth_rpc_register(rpc, "capture_burst", on_capture_burst, NULL);
+	rpc_log_if_register_failure(err);
+
 	err = golioth_rpc_register(rpc, "reboot", on_reboot, NULL);
 	rpc_log_if_register_failure(err);
 
@@ -10,9 +10,16 @@
  *
  * This demonstration implements the following RPCs:
  * - `get_network_info`: Query and return network information.
+ * - `get_boot_timeline`: uptime in ms of each boot milestone (see app_boot.h)
+ * - `get_profile`: duration histograms of the sensor loop stages, which are
+ *   then reset (see app_prof.h)
+ * - `get_history`: one page of the readings kept on the device (see
+ *   app_history.h)
+ * - `capture_burst`: sample the moisture probe and accelerometer at a high
+ *   rate for a few seconds and upload the capture (see app_burst.h)
  * - `reboot`: reboot the device (no arguments)
- * - `set_log_level`: adjust the logging level for all registered modules (valid
- *   argument values: 0..4)
+ * - `set_log_level`: adjust the logging level for all registered modules, or
+ *   for the modules named after the level (valid level values: 0..4)
  *
  * https://docs.golioth.io/firmware/zephyr-device-sdk/remote-procedure-call
  */
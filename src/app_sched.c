@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_sched, LOG_LEVEL_DBG);
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include "main.h"
+#include "app_sched.h"
+#include "app_settings.h"
+
+static struct app_sched_task tasks[APP_TASK_COUNT];
+
+/* Everything is read once at boot */
+static atomic_t requested = ATOMIC_INIT(APP_TASK_ALL);
+
+/* Index of the period of `task` holding `ms`; periods start at its phase */
+static int64_t task_period_index(const struct app_sched_task *task, int64_t ms)
+{
+	int64_t offset = ms - task->phase_ms;
+
+	/* Round down, including before the first period */
+	return (offset >= 0) ? (offset / task->period_ms)
+			     : -((task->period_ms - 1 - offset) / task->period_ms);
+}
+
+/* First slot boundary at or after the next period of `task` */
+static int64_t task_next_ms(const struct app_sched_task *task, int64_t slot_ms)
+{
+	int64_t due_ms = task->phase_ms + (task->last_period + 1) * task->period_ms;
+
+	return DIV_ROUND_UP(due_ms, slot_ms) * slot_ms;
+}
+
+void app_sched_task_set_period(struct app_sched_task *task, int64_t period_ms, int64_t phase_ms,
+			       int64_t now_ms)
+{
+	phase_ms %= period_ms;
+
+	if ((task->period_ms == period_ms) && (task->phase_ms == phase_ms)) {
+		return;
+	}
+
+	task->period_ms = period_ms;
+	task->phase_ms = phase_ms;
+	task->last_period = task_period_index(task, now_ms);
+}
+
+uint32_t app_sched_due(struct app_sched_task *tasks, size_t count, int64_t slot_ms,
+		       int64_t now_ms, int64_t *next_ms)
+{
+	uint32_t due = 0;
+	int64_t task_ms;
+
+	*next_ms = INT64_MAX;
+
+	for (size_t i = 0; i < count; i++) {
+		struct app_sched_task *task = &tasks[i];
+
+		task_ms = task_next_ms(task, slot_ms);
+		if (task_ms <= now_ms) {
+			due |= BIT(i);
+			LOG_DBG("Task %zu is %lld ms late", i, now_ms - task_ms);
+
+			/* Skip any period that was missed */
+			task->last_period = task_period_index(task, now_ms);
+			task_ms = task_next_ms(task, slot_ms);
+		}
+
+		*next_ms = MIN(*next_ms, task_ms);
+	}
+
+	return due;
+}
+
+uint32_t app_sched_poll(int64_t *wake_ms)
+{
+	int64_t now_ms = k_uptime_get();
+	struct app_config cfg;
+
+	app_config_get(&cfg);
+
+	for (int i = 0; i < APP_TASK_COUNT; i++) {
+		app_sched_task_set_period(&tasks[i],
+					  (int64_t)app_config_task_period_s(&cfg, i) * MSEC_PER_SEC,
+					  (int64_t)cfg.phase_s[i] * MSEC_PER_SEC, now_ms);
+	}
+
+	return app_sched_due(tasks, ARRAY_SIZE(tasks), CONFIG_APP_SCHED_SLOT_S * MSEC_PER_SEC,
+			     now_ms, wake_ms) |
+	       atomic_clear(&requested);
+}
+
+void app_sched_request(uint32_t tasks)
+{
+	atomic_or(&requested, tasks);
+	wake_system_thread();
+}
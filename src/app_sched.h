@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Multi-cadence sensor schedule.
+ *
+ * Every sensor, and the battery monitor, is a task with its own period, set by
+ * its `PERIOD_*_S` setting (see app_settings.h). A task is due at every
+ * multiple of its period since boot, shifted by the phase set by its
+ * `PHASE_*_S` setting so that tasks with the same period can be read apart.
+ * Due times are rounded up to a grid of
+ * `CONFIG_APP_SCHED_SLOT_S` and all tasks due in the same slot are read in a
+ * single cycle, so sensors with related periods share one bus power-up and one
+ * upload instead of each waking the device.
+ *
+ * A late wake-up never makes a task run twice: missed periods are skipped and
+ * the task stays on its grid, so lateness does not accumulate from one period
+ * to the next.
+ *
+ * The main loop calls `app_sched_poll()` to get the tasks due now and the time
+ * of the next slot, and sleeps until then. Sensor interrupts and the user
+ * button use `app_sched_request()` to read a sensor right away.
+ */
+
+#ifndef __APP_SCHED_H__
+#define __APP_SCHED_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+enum app_task {
+	APP_TASK_MOISTURE,
+	APP_TASK_LIGHT,
+	APP_TASK_WEATHER,
+	APP_TASK_IMU,
+	APP_TASK_BATTERY,
+	APP_TASK_COUNT
+};
+
+#define APP_TASK_ALL BIT_MASK(APP_TASK_COUNT)
+
+struct app_sched_task {
+	int64_t period_ms;
+	/* Start of the first period after boot, below `period_ms` */
+	int64_t phase_ms;
+	/* Index of the last period the task ran in */
+	int64_t last_period;
+};
+
+/**
+ * Change the period and phase of a task. The task keeps its grid when both
+ * are unchanged; otherwise it next runs at the first point of the new grid
+ * after `now_ms`.
+ *
+ * @param phase_ms offset of the grid from boot, taken modulo `period_ms`
+ */
+void app_sched_task_set_period(struct app_sched_task *task, int64_t period_ms, int64_t phase_ms,
+			       int64_t now_ms);
+
+/**
+ * Find the tasks due by `now_ms` and move them to their next period.
+ *
+ * @param slot_ms due times are rounded up to a multiple of this
+ * @param next_ms set to the start of the next slot in which a task is due
+ *
+ * @return bitmask of the due tasks
+ */
+uint32_t app_sched_due(struct app_sched_task *tasks, size_t count, int64_t slot_ms,
+		       int64_t now_ms, int64_t *next_ms);
+
+/**
+ * Tasks to run now, including requested ones, using the periods currently
+ * set. Every task is due on the first call.
+ *
+ * @param wake_ms set to the uptime at which to call again
+ */
+uint32_t app_sched_poll(int64_t *wake_ms);
+
+/** Run `tasks` as soon as possible; may be called from an ISR */
+void app_sched_request(uint32_t tasks);
+
+#endif /* __APP_SCHED_H__ */
@@ -7,19 +7,30 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(app_sensors, LOG_LEVEL_DBG);
 
+#include <string.h>
 #include <golioth/client.h>
-#include <golioth/stream.h>
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/sensor.h>
 #include <zephyr/kernel.h>
 
+#include "app_boot.h"
+#include "app_burst.h"
+#include "app_fixed.h"
+#include "app_history.h"
+#include "app_imu.h"
+#include "app_light.h"
+#include "app_moisture.h"
+#include "app_prof.h"
+#include "app_sched.h"
 #include "app_sensors.h"
 #include "app_settings.h"
+#include "app_stats.h"
+#include "app_stream.h"
+#include "app_vwc.h"
 
 #ifdef CONFIG_LIB_OSTENTUS
-#include <libostentus.h>
-static const struct device *o_dev = DEVICE_DT_GET_ANY(golioth_ostentus);
+#include "app_display.h"
 #endif
 #ifdef CONFIG_ALUDEL_BATTERY_MONITOR
 #include <battery_monitor.h>
@@ -27,239 +38,667 @@ static const struct device *o_dev = DEVICE_DT_GET_ANY(golioth_ostentus);
 
 static struct golioth_client *client;
 
-/* Sensors */
-static const struct device *imu_sensor;
-static const struct device *weather_sensor;
-static const struct device *light_sensor;
-
+/* Moisture classification result of the most recent sample */
 uint32_t moisture_level;
 
-/* Callback for LightDB Stream */
-static void async_error_handler(struct golioth_client *client, enum golioth_status status,
-				const struct golioth_coap_rsp_code *coap_rsp_code, const char *path,
-				void *arg)
+#define CHANNEL_INFO(_id, _group, _key, _deadband, _flags, _label, _unit)                          \
+	[APP_CH_##_id] = {                                                                         \
+		.group = _group,                                                                   \
+		.key = _key,                                                                       \
+		.milli = ((_flags) & APP_CH_F_MILLI) != 0,                                         \
+		.deadband = _deadband,                                                             \
+		.urgent = ((_flags) & APP_CH_F_URGENT) != 0,                                       \
+		.stats = ((_flags) & APP_CH_F_NO_STATS) == 0,                                      \
+		.slide_label = _label,                                                             \
+		.slide_unit = _unit,                                                               \
+	},
+#define CHANNEL_INFO_X(_id, _chan, ...) CHANNEL_INFO(_id, __VA_ARGS__)
+
+const struct app_channel_info app_channels[APP_CH_COUNT] = {
+	APP_CHANNELS(CHANNEL_INFO_X, CHANNEL_INFO)
+};
+
+/*
+ * Acquisition engine
+ *
+ * Every device read is an acquisition job. All jobs of a cycle are queued at
+ * once and each one raises its poll signal when it completes; the caller then
+ * collects the completions with k_poll() up to a deadline, so a slow or hung
+ * device does not stall the loop.
+ *
+ * The MCP3221 is read with i2c_transfer_signal() where the I2C driver supports
+ * callback transfers. Sensor API drivers only offer a blocking fetch, so those
+ * jobs run on a dedicated work queue at the main thread priority. Each job is a
+ * separate work item and the I2C driver grants the bus to waiting threads in
+ * FIFO order, so Ostentus writes from the main thread interleave with sensor
+ * transactions instead of waiting for the whole set.
+ */
+#define ACQ_JOB_MAX_CHANS 4
+
+struct acq_job {
+	struct k_work work;
+	struct k_poll_signal signal;
+	const char *name;
+	const struct device *dev;
+	/* Scheduled task that reads this device */
+	enum app_task task;
+	/* Optional non-blocking start; return -ENOSYS to fall back to fetch() */
+	int (*start)(struct acq_job *job);
+	/* Blocking read, run on the acquisition work queue */
+	int (*fetch)(struct acq_job *job);
+	/* Optional post-processing, run by the collecting thread */
+	void (*complete)(struct acq_job *job);
+	const enum sensor_channel *sensor_chans;
+	const enum app_channel *app_chans;
+	size_t num_chans;
+	/* Readings in the units of the matching app channel */
+	int32_t val[ACQ_JOB_MAX_CHANS];
+	/*
+	 * Outcome of the last cycle: 0, a negative error code, -EAGAIN on timeout
+	 * or -EBUSY if the previous read was still in progress
+	 */
+	int result;
+	bool busy;
+#ifdef CONFIG_APP_PROF
+	/* From app_prof_start(), when the read was queued */
+	uint32_t prof_start;
+#endif
+};
+
+#ifdef CONFIG_APP_SENSORS_ASYNC
+static K_THREAD_STACK_DEFINE(acq_stack, CONFIG_APP_SENSORS_ACQ_STACK_SIZE);
+static struct k_work_q acq_work_q;
+#endif
+
+static int sensor_job_fetch(struct acq_job *job)
 {
-	if (status != GOLIOTH_OK) {
-		LOG_ERR("Async task failed: %d", status);
-		return;
+	int err;
+
+	err = sensor_sample_fetch(job->dev);
+	if (err) {
+		return err;
+	}
+
+	for (size_t i = 0; i < job->num_chans; i++) {
+		struct sensor_value val;
+
+		err = sensor_channel_get(job->dev, job->sensor_chans[i], &val);
+		if (err) {
+			return err;
+		}
+
+		/* Convert once, here; the rest of the data path is integer only */
+		job->val[i] = app_channels[job->app_chans[i]].milli ? sensor_value_to_milli(&val)
+								     : val.val1;
 	}
+
+	return 0;
 }
 
-/* This will be called by the main() loop */
-/* Do all of your work here! */
-void app_sensors_read_and_stream(void)
+#if APP_HAS_MOISTURE
+/*
+ * Direct I2C access to MCP3221; buffers must outlive a callback transfer.
+ *
+ * The MCP3221 keeps converting and sending results for as long as the master
+ * acknowledges, so a burst of conversions is a single read transaction.
+ */
+static uint8_t mcp3221_wr[1] = {0x00};
+static uint8_t mcp3221_rd[2 * CONFIG_APP_MOISTURE_OVERSAMPLE];
+static struct i2c_msg mcp3221_msgs[2];
+
+/* Moisture filter state, carried across loops */
+static struct moisture_filter moisture_filter;
+
+/* Settings snapshot the classification table was built from */
+static uint32_t classifier_version;
+
+#if APP_HAS_WEATHER
+/* Last temperature read, in m°C, for temperature compensation of the probe */
+static int32_t probe_temp;
+static int64_t probe_temp_ms;
+static bool probe_temp_valid;
+#endif
+
+static void mcp3221_msgs_init(void)
+{
+	/* Read the data register from the MCP3221 */
+	mcp3221_msgs[0].buf = mcp3221_wr;
+	mcp3221_msgs[0].len = sizeof(mcp3221_wr);
+	mcp3221_msgs[0].flags = I2C_MSG_WRITE;
+
+	mcp3221_msgs[1].buf = mcp3221_rd;
+	mcp3221_msgs[1].len = sizeof(mcp3221_rd);
+	mcp3221_msgs[1].flags = I2C_MSG_RESTART | I2C_MSG_READ | I2C_MSG_STOP;
+}
+
+static int mcp3221_start(struct acq_job *job)
+{
+	mcp3221_msgs_init();
+
+	COND_CODE_1(CONFIG_I2C_CALLBACK,
+		    (return i2c_transfer_signal(job->dev, mcp3221_msgs, ARRAY_SIZE(mcp3221_msgs),
+						MCP3221_I2C_ADDR, &job->signal);),
+		    (return -ENOSYS;));
+}
+
+static int mcp3221_fetch(struct acq_job *job)
+{
+	mcp3221_msgs_init();
+
+	return i2c_transfer(job->dev, mcp3221_msgs, ARRAY_SIZE(mcp3221_msgs), MCP3221_I2C_ADDR);
+}
+
+static void mcp3221_complete(struct acq_job *job)
 {
+	uint16_t burst[CONFIG_APP_MOISTURE_OVERSAMPLE];
+	uint32_t start;
+	uint16_t filtered;
+
+	for (int i = 0; i < CONFIG_APP_MOISTURE_OVERSAMPLE; i++) {
+		burst[i] = ((mcp3221_rd[2 * i] << 8) + mcp3221_rd[(2 * i) + 1]) &
+			   MOISTURE_ADC_MAX;
+	}
+
+	/* The first conversion is reported unfiltered */
+	job->val[0] = burst[0];
+
+	start = app_prof_start();
+
+	filtered = moisture_burst_reduce(burst, ARRAY_SIZE(burst), CONFIG_APP_MOISTURE_TRIM);
+	filtered = moisture_filter_update(&moisture_filter, filtered,
+					  CONFIG_APP_MOISTURE_EMA_SHIFT);
+
+	app_prof_record(APP_PROF_MOISTURE_FILTER, start);
+
+	job->val[1] = filtered;
+}
+
+/* Convert the filtered moisture reading of `sample` to volumetric water content */
+static void moisture_vwc_convert(const struct app_config *cfg, struct app_sample *sample)
+{
+	uint32_t start = app_prof_start();
+	int32_t raw_q = sample->val[APP_CH_MOISTURE_FILTERED] << VWC_RAW_FRAC_BITS;
+
+#if APP_HAS_WEATHER
+	/*
+	 * A temperature missing a whole weather period, plus the slot it may be
+	 * late by, comes from a sensor that stopped responding.
+	 */
+	int64_t temp_max_age_ms =
+		((int64_t)app_config_task_period_s(cfg, APP_TASK_WEATHER) + CONFIG_APP_SCHED_SLOT_S) *
+		MSEC_PER_SEC;
+
+	if (probe_temp_valid && (sample->uptime_ms - probe_temp_ms > temp_max_age_ms)) {
+		LOG_WRN("Temperature is %lld s old, VWC is not compensated",
+			(sample->uptime_ms - probe_temp_ms) / MSEC_PER_SEC);
+		probe_temp_valid = false;
+	}
+
+	if (cfg->vwc_temp_coeff && probe_temp_valid) {
+		raw_q = vwc_temp_compensate(sample->val[APP_CH_MOISTURE_FILTERED], probe_temp,
+					    cfg->vwc_temp_coeff, cfg->vwc_temp_ref_c);
+	}
+#endif
+
+	sample->val[APP_CH_MOISTURE_VWC] = vwc_eval(&cfg->vwc_curve, raw_q);
+	sample->mask |= BIT(APP_CH_MOISTURE_VWC);
+	app_prof_record(APP_PROF_VWC, start);
+
+	LOG_DBG("Moisture VWC is " PRIMILLI " %%", MILLI_ARGS(sample->val[APP_CH_MOISTURE_VWC]));
+}
+#endif /* APP_HAS_MOISTURE */
+
+#ifdef CONFIG_APP_IMU_FIFO
+static bool imu_fifo_enabled;
+
+/* Peak-to-peak of the last drain; only valid if it succeeded */
+static int32_t imu_p2p;
+static bool imu_p2p_valid;
+
+static int imu_fifo_fetch(struct acq_job *job)
+{
+	struct app_imu_window window;
+	int count;
+
+	imu_p2p_valid = false;
+
+	if (imu_fifo_enabled) {
+		count = app_imu_fifo_drain(&window);
+		if (count >= 0) {
+			LOG_DBG("Drained %d IMU samples", count);
+			memcpy(job->val, window.mean, sizeof(window.mean));
+			imu_p2p = window.p2p;
+			imu_p2p_valid = true;
+			return 0;
+		}
+		if (count != -ENODATA) {
+			return count;
+		}
+	}
+
+	/* Nothing buffered yet: take a single sample */
+	return sensor_job_fetch(job);
+}
+#endif
+
+#ifdef CONFIG_APP_LIGHT_INT
+static bool light_int_enabled;
+
+static int light_int_fetch(struct acq_job *job)
+{
+	/* Consume the latched values instead of waiting for a new conversion */
+	if (light_int_enabled) {
+		return app_light_read(job->val);
+	}
+
+	return sensor_job_fetch(job);
+}
+#endif
+
+/*
+ * Jobs are generated from the sensor registry (see app_sensors.h): the X
+ * entries of a sensor are the readings of its job, in order, and the device
+ * comes straight from the devicetree node.
+ */
+#define JOB_SENSOR_CHAN(_id, _chan, ...) SENSOR_CHAN_##_chan,
+#define JOB_APP_CHAN(_id, ...) APP_CH_##_id,
+#define JOB_SKIP(...)
+
+#define JOB_CHANS(_job, _channels)                                                                 \
+	static const enum sensor_channel _job##_sensor_chans[] = {                                 \
+		_channels(JOB_SENSOR_CHAN, JOB_SKIP)};                                             \
+	static const enum app_channel _job##_app_chans[] = {                                       \
+		_channels(JOB_APP_CHAN, JOB_SKIP)};                                                \
+	BUILD_ASSERT(ARRAY_SIZE(_job##_app_chans) <= ACQ_JOB_MAX_CHANS, "Too many channels")
+
+#define JOB(_job, _name, _node, _task, ...)                                                        \
+	{                                                                                          \
+		.name = _name, .dev = DEVICE_DT_GET(_node), .task = _task,                         \
+		.sensor_chans = _job##_sensor_chans, .app_chans = _job##_app_chans,                \
+		.num_chans = ARRAY_SIZE(_job##_app_chans), __VA_ARGS__                             \
+	}
+
+enum {
+	IF_ENABLED(APP_HAS_IMU, (ACQ_JOB_IMU,))
+	IF_ENABLED(APP_HAS_WEATHER, (ACQ_JOB_WEATHER,))
+	IF_ENABLED(APP_HAS_LIGHT, (ACQ_JOB_LIGHT,))
+	IF_ENABLED(APP_HAS_MOISTURE, (ACQ_JOB_MOISTURE,))
+	ACQ_JOB_COUNT
+};
+
+IF_ENABLED(APP_HAS_IMU, (JOB_CHANS(imu, APP_IMU_CHANNELS);))
+IF_ENABLED(APP_HAS_WEATHER, (JOB_CHANS(weather, APP_WEATHER_CHANNELS);))
+IF_ENABLED(APP_HAS_LIGHT, (JOB_CHANS(light, APP_LIGHT_CHANNELS);))
+IF_ENABLED(APP_HAS_MOISTURE, (JOB_CHANS(moisture, APP_MOISTURE_CHANNELS);))
+
+static struct acq_job acq_jobs[ACQ_JOB_COUNT] = {
+#if APP_HAS_IMU
+	[ACQ_JOB_IMU] = JOB(imu, "IMU", APP_IMU_NODE, APP_TASK_IMU,
+			    .fetch = COND_CODE_1(CONFIG_APP_IMU_FIFO, (imu_fifo_fetch),
+						 (sensor_job_fetch))),
+#endif
+#if APP_HAS_WEATHER
+	[ACQ_JOB_WEATHER] = JOB(weather, "Weather", APP_WEATHER_NODE, APP_TASK_WEATHER,
+				.fetch = sensor_job_fetch),
+#endif
+#if APP_HAS_LIGHT
+	[ACQ_JOB_LIGHT] = JOB(light, "Light", APP_LIGHT_NODE, APP_TASK_LIGHT,
+			      .fetch = COND_CODE_1(CONFIG_APP_LIGHT_INT, (light_int_fetch),
+						   (sensor_job_fetch))),
+#endif
+#if APP_HAS_MOISTURE
+	/* The MCP3221 is read over raw I2C; its sensor channels are not used */
+	[ACQ_JOB_MOISTURE] = JOB(moisture, "Moisture", APP_MOISTURE_NODE, APP_TASK_MOISTURE,
+				 .start = mcp3221_start, .fetch = mcp3221_fetch,
+				 .complete = mcp3221_complete),
+#endif
+};
+
+#ifdef CONFIG_APP_SENSORS_ASYNC
+static void acq_work_handler(struct k_work *work)
+{
+	struct acq_job *job = CONTAINER_OF(work, struct acq_job, work);
+
+	k_poll_signal_raise(&job->signal, job->fetch(job));
+}
+#endif
+
+static void acq_job_start(struct acq_job *job)
+{
+	unsigned int signaled;
+	int result;
 	int err;
-	char json_buf[256];
-	struct sensor_value temp = {0};
-	struct sensor_value pressure = {0};
-	struct sensor_value humidity = {0};
-	struct sensor_value accel_x = {0};
-	struct sensor_value accel_y = {0};
-	struct sensor_value accel_z = {0};
-	struct sensor_value intensity = {0};
-	struct sensor_value red = {0};
-	struct sensor_value green = {0};
-	struct sensor_value blue = {0};
 
-	/* Golioth custom hardware for demos */
-	IF_ENABLED(CONFIG_ALUDEL_BATTERY_MONITOR, (
-		read_and_report_battery(client);
-		IF_ENABLED(CONFIG_LIB_OSTENTUS, (
-			ostentus_slide_set(o_dev,
-					   BATTERY_V,
-					   get_batt_v_str(),
-					   strlen(get_batt_v_str()));
-			ostentus_slide_set(o_dev,
-					   BATTERY_PCT,
-					   get_batt_pct_str(),
-					   strlen(get_batt_pct_str()));
-		));
-	));
+	if (job->busy) {
+		/* A job that missed the previous deadline may still be on the bus */
+		k_poll_signal_check(&job->signal, &signaled, &result);
+		if (!signaled) {
+			LOG_WRN("%s read still in progress, skipping", job->name);
+			job->result = -EBUSY;
+			return;
+		}
+	}
 
-	/* Direct I2C access to MCP3221 */
-	uint8_t mcp3221[2] = {0};
-	uint32_t moisture_reading = 0;
+	k_poll_signal_reset(&job->signal);
+	job->busy = true;
+	job->result = -EAGAIN;
+	IF_ENABLED(CONFIG_APP_PROF, (job->prof_start = app_prof_start();));
 
-	const struct device *i2c_dev = DEVICE_DT_GET(DT_ALIAS(click_i2c));
-	if (i2c_dev==NULL||!device_is_ready(i2c_dev))
-	{
-		LOG_ERR("Could not get i2c device\n");
+	if (!device_is_ready(job->dev)) {
+		k_poll_signal_raise(&job->signal, -ENODEV);
 		return;
 	}
 
-	/* IMU sensor reading */
-	err = sensor_sample_fetch(imu_sensor);
-	if (err) {
-		LOG_ERR("IMU sensor fetch failed: %d", err);
-	} else {
-		sensor_channel_get(imu_sensor, SENSOR_CHAN_ACCEL_X, &accel_x);
-		sensor_channel_get(imu_sensor, SENSOR_CHAN_ACCEL_Y, &accel_y);
-		sensor_channel_get(imu_sensor, SENSOR_CHAN_ACCEL_Z, &accel_z);
-
-		LOG_DBG("IMU: x=%d.%06d; y=%d.%06d, z=%d.%06d",
-			accel_x.val1, abs(accel_x.val2),
-			accel_y.val1, abs(accel_y.val2),
-			accel_z.val1, abs(accel_z.val2));
+#ifdef CONFIG_APP_SENSORS_ASYNC
+	if (job->start) {
+		err = job->start(job);
+		if (err != -ENOSYS) {
+			if (err) {
+				k_poll_signal_raise(&job->signal, err);
+			}
+			return;
+		}
 	}
 
-	/* Weather Sensor Reading */
-	err = sensor_sample_fetch(weather_sensor);
-	if (err) {
-		LOG_ERR("Weather sensor fetch failed: %d", err);
-	} else {
-		sensor_channel_get(weather_sensor, SENSOR_CHAN_AMBIENT_TEMP, &temp);
-		sensor_channel_get(weather_sensor, SENSOR_CHAN_PRESS, &pressure);
-		sensor_channel_get(weather_sensor, SENSOR_CHAN_HUMIDITY, &humidity);
-
-		LOG_DBG("Weather: temp=%d.%06d; pressure=%d.%06d, humidity=%d.%06d",
-			temp.val1, abs(temp.val2),
-			pressure.val1, abs(pressure.val2),
-			humidity.val1, abs(humidity.val2));
-	}
+	k_work_submit_to_queue(&acq_work_q, &job->work);
+#else
+	err = job->fetch(job);
+	k_poll_signal_raise(&job->signal, err);
+#endif
+}
 
-	/* Light Sensor Reading */
-	err = sensor_sample_fetch(light_sensor);
-	if (err) {
-		LOG_ERR("Light sensor fetch failed: %d", err);
-	} else {
-		sensor_channel_get(light_sensor, SENSOR_CHAN_LIGHT, &intensity);
-		sensor_channel_get(light_sensor, SENSOR_CHAN_RED, &red);
-		sensor_channel_get(light_sensor, SENSOR_CHAN_GREEN, &green);
-		sensor_channel_get(light_sensor, SENSOR_CHAN_BLUE, &blue);
+static void acq_job_collect(struct acq_job *job, struct app_sample *sample, int result)
+{
+	job->busy = false;
+	job->result = result;
+	IF_ENABLED(CONFIG_APP_PROF, (app_prof_record(APP_PROF_READ + job->task, job->prof_start);));
 
-		LOG_DBG("Light: %d; r=%d, g=%d, b=%d", intensity.val1, red.val1, green.val1, blue.val1);
+	if (result) {
+		LOG_ERR("%s read failed: %d", job->name, result);
+		return;
 	}
 
-	/* Read the data register from the MCP3221 */
-	uint8_t write_data[1] = { 0x00 };
+	if (job->complete) {
+		job->complete(job);
+	}
 
-	err = i2c_write_read(i2c_dev, 0x4D, write_data, 1, mcp3221, 2);
-	if (err) {
-		LOG_ERR("Unable get Moisture Reading (err %i)", err);
-	} else {
-		moisture_reading = (mcp3221[0] << 8) + mcp3221[1];
-		LOG_DBG("Moisture Reading: %d", moisture_reading);
-
-		// Remember, the values are inverted! The value of a "0" moisture is higher than "100"
-		if (moisture_reading > get_moisture_level_threshold(0)) {
-			moisture_level = 0;
-			LOG_DBG("Moisture level set to 0");
-		} else if (moisture_reading > get_moisture_level_threshold(20)
-			&& moisture_reading < get_moisture_level_threshold(0)) {
-			moisture_level = 20;
-			LOG_DBG("Moisture level set to 20");
-
-		} else if (moisture_reading > get_moisture_level_threshold(40)
-			&& moisture_reading < get_moisture_level_threshold(20)) {
-			moisture_level = 40;
-			LOG_DBG("Moisture level set to 40");
-
-		} else if (moisture_reading > get_moisture_level_threshold(60)
-			&& moisture_reading < get_moisture_level_threshold(40)) {
-			moisture_level = 60;
-			LOG_DBG("Moisture level set to 60");
-
-		} else if (moisture_reading > get_moisture_level_threshold(80)
-			&& moisture_reading < get_moisture_level_threshold(60)) {
-			moisture_level = 80;
-			LOG_DBG("Moisture level set to 80");
-
-		} else if (moisture_reading < get_moisture_level_threshold(80)) {
-			moisture_level = 100;
-			LOG_DBG("Moisture level set to 100");
+	for (size_t i = 0; i < job->num_chans; i++) {
+		const struct app_channel_info *info = &app_channels[job->app_chans[i]];
+
+		sample->val[job->app_chans[i]] = job->val[i];
+		sample->mask |= BIT(job->app_chans[i]);
 
+		if (info->milli) {
+			LOG_DBG("%s %s=" PRIMILLI, job->name, info->key, MILLI_ARGS(job->val[i]));
 		} else {
-			/* Error state */
-			LOG_ERR("Your math or your moisture threshold limits are wrong. Check settings.");
+			LOG_DBG("%s %s=%d", job->name, info->key, job->val[i]);
 		}
+	}
+}
 
-		LOG_DBG("Moisture level is %d", moisture_level);
+/* Queue a read on every device of `tasks` */
+static void acq_start(uint32_t tasks)
+{
+	for (int i = 0; i < ACQ_JOB_COUNT; i++) {
+		if (tasks & BIT(acq_jobs[i].task)) {
+			acq_job_start(&acq_jobs[i]);
+		}
 	}
+}
 
-	/* Send sensor data to Golioth */
-	snprintk(json_buf, sizeof(json_buf),
-		"{\"imu\":{\"accel_x\":%f,\"accel_y\":%f,\"accel_z\":%f},\
-		\"weather\":{\"temp\":%f,\"pressure\":%f,\"humidity\":%f},\
-		\"moisture\":{\"raw\":%d,\"level\":%d},\
-		\"light\":{\"int\":%d,\"r\":%d,\"g\":%d,\"b\":%d}}",
-		sensor_value_to_double(&accel_x),
-		sensor_value_to_double(&accel_y),
-		sensor_value_to_double(&accel_z),
-		sensor_value_to_double(&temp),
-		sensor_value_to_double(&pressure),
-		sensor_value_to_double(&humidity),
-		moisture_reading,			// send back raw moisture readings from i2c sensor
-		moisture_level,				// this is the 'level' that will be used in animations on the console, currently a fake value.
-		intensity.val1,
-		red.val1,
-		green.val1,
-		blue.val1
-		);
-
-	/* Only stream sensor data if connected */
-	if (golioth_client_is_connected(client)) {
-		err = golioth_stream_set_async(client,
-					       "sensor",
-					       GOLIOTH_CONTENT_TYPE_JSON,
-					       json_buf,
-					       strlen(json_buf),
-					       async_error_handler,
-					       NULL);
+/*
+ * Collect completed reads of `tasks` into `sample` until all are done or the
+ * deadline passes
+ */
+static void acq_collect(uint32_t tasks, struct app_sample *sample, int64_t deadline_ms)
+{
+	struct k_poll_event events[ACQ_JOB_COUNT];
+	struct acq_job *pending[ACQ_JOB_COUNT];
+	unsigned int signaled;
+	int num_pending;
+	int result;
+	int err;
 
-		if (err) {
-			LOG_ERR("Failed to send sensor data to Golioth: %d", err);
+	do {
+		num_pending = 0;
+
+		for (int i = 0; i < ACQ_JOB_COUNT; i++) {
+			struct acq_job *job = &acq_jobs[i];
+
+			/* Leave a late read of another task to the next cycle of that task */
+			if (!job->busy || !(tasks & BIT(job->task))) {
+				continue;
+			}
+
+			/*
+			 * Skipped this cycle: the read still in flight belongs to a previous
+			 * sample, so its channels stay out of this one
+			 */
+			if (job->result == -EBUSY) {
+				continue;
+			}
+
+			k_poll_signal_check(&job->signal, &signaled, &result);
+			if (signaled) {
+				acq_job_collect(job, sample, result);
+				continue;
+			}
+
+			k_poll_event_init(&events[num_pending], K_POLL_TYPE_SIGNAL,
+					  K_POLL_MODE_NOTIFY_ONLY, &job->signal);
+			pending[num_pending++] = job;
+		}
+
+		if (num_pending == 0) {
+			return;
 		}
+
+		err = k_poll(events, num_pending, K_TIMEOUT_ABS_MS(deadline_ms));
+	} while (err != -EAGAIN);
+
+	for (int i = 0; i < num_pending; i++) {
+		LOG_WRN("%s read timed out", pending[i]->name);
 	}
+}
+
+#ifdef CONFIG_LIB_OSTENTUS
+/* Show a milli-unit reading with two decimals */
+static void slide_set_milli(slide_key key, int32_t milli, const char *unit)
+{
+	char sbuf[APP_DISPLAY_VALUE_LEN];
+	uint32_t abs_milli = (milli < 0) ? -milli : milli;
+
+	snprintk(sbuf, sizeof(sbuf), "%s%u.%02u %s", (milli < 0) ? "-" : "",
+		 abs_milli / MILLI_PER_UNIT, (abs_milli % MILLI_PER_UNIT) / 10, unit);
+	app_display_slide_set(key, sbuf);
+}
+#endif
+
+/* This will be called by the main() loop */
+/* Do all of your work here! */
+void app_sensors_read_and_stream(uint32_t tasks)
+{
+	char sbuf[APP_DISPLAY_VALUE_LEN];
+	struct app_sample sample = {0};
+	struct app_config cfg;
+	int32_t *val = sample.val;
+	uint32_t cycle_start = k_cycle_get_32();
+	uint32_t acq_cycles;
+	uint32_t enqueue_start;
+
+	/* Settings may change while the cycle runs; use one snapshot throughout */
+	app_config_get(&cfg);
+
+	/* Queue the due sensor reads; they complete while the battery is read */
+	sample.uptime_ms = k_uptime_get();
+	acq_start(tasks);
 
 	/* Golioth custom hardware for demos */
-	IF_ENABLED(CONFIG_LIB_OSTENTUS, (
-		/* Update slide values on Ostentus
-		 *  -values should be sent as strings
-		 *  -use the enum from app_sensors.h for slide key values
-		 */
-		snprintk(json_buf, sizeof(json_buf), "%d", moisture_reading);
-		ostentus_slide_set(o_dev, MOISTURE_READING_KEY, json_buf, strlen(json_buf));
+	IF_ENABLED(CONFIG_ALUDEL_BATTERY_MONITOR, (
+		if (tasks & BIT(APP_TASK_BATTERY)) {
+			uint32_t battery_start = app_prof_start();
+
+			read_and_report_battery(client);
+			app_prof_record(APP_PROF_READ + APP_TASK_BATTERY, battery_start);
+			IF_ENABLED(CONFIG_LIB_OSTENTUS, (
+				app_display_slide_set(BATTERY_V, get_batt_v_str());
+				app_display_slide_set(BATTERY_PCT, get_batt_pct_str());
+			));
+		}
+	));
+
+	acq_collect(tasks, &sample, sample.uptime_ms + CONFIG_APP_SENSORS_ACQ_TIMEOUT_MS);
+	acq_cycles = k_cycle_get_32() - cycle_start;
+	app_prof_record(APP_PROF_ACQ, cycle_start);
+
+	IF_ENABLED(CONFIG_APP_IMU_FIFO, (
+		if ((tasks & BIT(APP_TASK_IMU)) && (acq_jobs[ACQ_JOB_IMU].result == 0) &&
+		    imu_p2p_valid) {
+			val[APP_CH_ACCEL_P2P] = imu_p2p;
+			sample.mask |= BIT(APP_CH_ACCEL_P2P);
+		}
+	));
+
+	IF_ENABLED(CONFIG_APP_IMU_MOTION, (
+		if (tasks & BIT(APP_TASK_IMU)) {
+			val[APP_CH_MOTION] = app_imu_motion_count();
+			sample.mask |= BIT(APP_CH_MOTION);
+		}
+	));
+
+#if APP_HAS_MOISTURE
+	/* Classify the filtered reading */
+	uint32_t moisture_reading = val[APP_CH_MOISTURE_FILTERED];
+
+	if (cfg.version != classifier_version) {
+		app_settings_moisture_classifier_build(&cfg);
+		classifier_version = cfg.version;
+	}
+
+	if ((tasks & BIT(APP_TASK_MOISTURE)) && (acq_jobs[ACQ_JOB_MOISTURE].result == 0)) {
+		moisture_level = moisture_classify(moisture_reading);
+		LOG_DBG("Moisture level is %d", moisture_level);
+
+		sample.mask |= BIT(APP_CH_MOISTURE_LEVEL);
+	}
+
+	/* this is the 'level' that will be used in animations on the console */
+	val[APP_CH_MOISTURE_LEVEL] = moisture_level;
+
+#if APP_HAS_WEATHER
+	if (sample.mask & BIT(APP_CH_TEMP)) {
+		probe_temp = val[APP_CH_TEMP];
+		probe_temp_ms = sample.uptime_ms;
+		probe_temp_valid = true;
+	}
+#endif
+
+	/* An uncalibrated probe only reports raw counts and the level */
+	if ((tasks & BIT(APP_TASK_MOISTURE)) && (acq_jobs[ACQ_JOB_MOISTURE].result == 0) &&
+	    cfg.vwc_curve.count) {
+		moisture_vwc_convert(&cfg, &sample);
+	}
+#endif
+
+	/* Every reading is kept on the device, whether it is uploaded or not */
+	if (sample.mask) {
+		app_history_add(&sample);
+	}
 
-		snprintk(json_buf, sizeof(json_buf), "%d", moisture_level);
-		ostentus_slide_set(o_dev, MOISTURE_LEVEL_KEY, json_buf, strlen(json_buf));
+	enqueue_start = app_prof_start();
 
-		snprintk(json_buf, sizeof(json_buf), "%d", intensity.val1);
-		ostentus_slide_set(o_dev, MOISTURE_LIGHT_INT, json_buf, strlen(json_buf));
+	if (!sample.mask) {
+		/* Nothing but the battery was due */
+	} else if (cfg.stats_window_s) {
+		/* Only a summary of the window is sent to Golioth */
+		app_stats_add(&sample);
+	} else {
+		/* Queue the sample; it is sent to Golioth as part of the next batch */
+		app_stats_reset();
+		app_stream_push(&sample);
+	}
 
-		snprintk(json_buf, sizeof(json_buf), "%d.%d C", temp.val1, (temp.val2 / 10000));
-		ostentus_slide_set(o_dev, TEMPERATURE, json_buf, strlen(json_buf));
+	app_prof_record(APP_PROF_ENQUEUE, enqueue_start);
 
-		snprintk(json_buf, sizeof(json_buf), "%d.%d kPa", pressure.val1, (pressure.val2 / 10000));
-		ostentus_slide_set(o_dev, PRESSURE, json_buf, strlen(json_buf));
+	if (sample.mask) {
+		app_boot_mark(APP_BOOT_FIRST_SAMPLE);
+	}
 
-		snprintk(json_buf, sizeof(json_buf), "%d.%d %%RH", humidity.val1, (humidity.val2 / 10000));
-		ostentus_slide_set(o_dev, HUMIDITY, json_buf, strlen(json_buf));
+	/* Golioth custom hardware for demos */
+	IF_ENABLED(CONFIG_LIB_OSTENTUS, (
+		/* Post slide values for Ostentus
+		 *  -values should be sent as strings
+		 *  -channels with a slide label use their channel number as the key
+		 *  -only changed slides are written, later, by the display work queue
+		 */
+		for (int i = 0; i < APP_CH_COUNT; i++) {
+			const struct app_channel_info *info = &app_channels[i];
+
+			if (!info->slide_label || !(sample.mask & BIT(i))) {
+				continue;
+			}
+
+			if (info->milli) {
+				slide_set_milli(i, val[i], info->slide_unit);
+			} else {
+				snprintk(sbuf, sizeof(sbuf), "%d", val[i]);
+				app_display_slide_set(i, sbuf);
+			}
+		}
 	));
+
+	LOG_DBG("Awake for %u us (sensor acquisition %u us)",
+		k_cyc_to_us_floor32(k_cycle_get_32() - cycle_start),
+		k_cyc_to_us_floor32(acq_cycles));
+	app_prof_record(APP_PROF_CYCLE, cycle_start);
 }
 
 void app_sensors_set_client(struct golioth_client *sensors_client)
 {
 	client = sensors_client;
+	app_stream_set_client(sensors_client);
+	app_stats_set_client(sensors_client);
+	app_burst_set_client(sensors_client);
 }
 
 void sensor_init(void)
 {
-	LOG_DBG("LIS2DH Init");
-	imu_sensor = (void *) DEVICE_DT_GET_ANY(st_lis2dh);
-	if (imu_sensor == NULL) {
-		LOG_ERR("Could not get lis2dh device");
+	/* Devices come from the devicetree; a missing one fails its job with -ENODEV */
+	for (int i = 0; i < ACQ_JOB_COUNT; i++) {
+		if (!device_is_ready(acq_jobs[i].dev)) {
+			LOG_ERR("%s device not ready", acq_jobs[i].name);
+		}
 	}
 
-	LOG_DBG("BME280 Init");
-	weather_sensor = (void *) DEVICE_DT_GET_ANY(bosch_bme280);
-	if (weather_sensor == NULL) {
-		LOG_ERR("Could not get bme280 device");
-	}
+	IF_ENABLED(CONFIG_APP_IMU_FIFO, (
+		if (device_is_ready(acq_jobs[ACQ_JOB_IMU].dev)) {
+			imu_fifo_enabled = (app_imu_init(acq_jobs[ACQ_JOB_IMU].dev) == 0);
+		}
+	));
+
+	IF_ENABLED(CONFIG_APP_LIGHT_INT, (
+		if (device_is_ready(acq_jobs[ACQ_JOB_LIGHT].dev)) {
+			light_int_enabled = (app_light_init(acq_jobs[ACQ_JOB_LIGHT].dev) == 0);
+		}
+	));
+
+	IF_ENABLED(APP_HAS_MOISTURE, (
+		moisture_filter_reset(&moisture_filter);
+	));
 
-	LOG_DBG("APDS9960 Init");
-	light_sensor = (void *) DEVICE_DT_GET_ANY(avago_apds9960);
-	if (light_sensor == NULL) {
-		LOG_ERR("Could not get apds9960 device");
+	for (int i = 0; i < ACQ_JOB_COUNT; i++) {
+		k_poll_signal_init(&acq_jobs[i].signal);
+		IF_ENABLED(CONFIG_APP_SENSORS_ASYNC,
+			   (k_work_init(&acq_jobs[i].work, acq_work_handler);));
 	}
+
+#ifdef CONFIG_APP_SENSORS_ASYNC
+	struct k_work_queue_config acq_cfg = {
+		.name = "acq_workq",
+	};
+
+	k_work_queue_init(&acq_work_q);
+	k_work_queue_start(&acq_work_q, acq_stack, K_THREAD_STACK_SIZEOF(acq_stack),
+			   CONFIG_MAIN_THREAD_PRIORITY, &acq_cfg);
+#endif
 }
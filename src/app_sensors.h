@@ -13,46 +13,175 @@
  *
  * For this demonstration, a `counter` value is periodically logged and pushed
  * to the Golioth time-series database. This simulated sensor reading occurs
- * when the loop in `main.c` calls `app_sensors_read_and_stream()`. The
- * frequency of this loop is determined by values received from the Golioth
- * Settings Service (see app_settings.h).
+ * when the loop in `main.c` calls `app_sensors_read_and_stream()` with the
+ * sensors that are due. How often each sensor is due is determined by values
+ * received from the Golioth Settings Service (see app_sched.h).
  *
  * https://docs.golioth.io/firmware/zephyr-device-sdk/light-db-stream/
  */
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <golioth/client.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/util.h>
+#include "app_settings.h"
+
+/*
+ * Sensor registry
+ *
+ * Each sensor is found through the devicetree at build time. A sensor that is
+ * not enabled on the board contributes no channels, acquisition job or slide,
+ * so its code and data compile out entirely. Another part with the same
+ * channels (e.g. a BME680 in place of the BME280) only needs a board overlay.
+ */
+#define APP_IMU_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(st_lis2dh)
+#define APP_WEATHER_NODE                                                                           \
+	COND_CODE_1(DT_HAS_COMPAT_STATUS_OKAY(bosch_bme280),                                       \
+		    (DT_COMPAT_GET_ANY_STATUS_OKAY(bosch_bme280)),                                 \
+		    (DT_COMPAT_GET_ANY_STATUS_OKAY(bosch_bme680)))
+#define APP_LIGHT_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(avago_apds9960)
+/* MCP3221 ADC on the mikroBUS (click) I2C bus */
+#define APP_MOISTURE_NODE DT_ALIAS(click_i2c)
+
+#define APP_HAS_IMU DT_NODE_EXISTS(APP_IMU_NODE)
+#define APP_HAS_WEATHER DT_NODE_EXISTS(APP_WEATHER_NODE)
+#define APP_HAS_LIGHT DT_NODE_EXISTS(APP_LIGHT_NODE)
+#define APP_HAS_MOISTURE DT_NODE_EXISTS(APP_MOISTURE_NODE)
+
+/* Channel flags */
+/* Readings are in milli-units and streamed with a fractional part */
+#define APP_CH_F_MILLI BIT(0)
+/* Report any change immediately, regardless of deadband and batch size */
+#define APP_CH_F_URGENT BIT(1)
+/* Derived from other channels or a counter; left out of window statistics */
+#define APP_CH_F_NO_STATS BIT(2)
+
+/*
+ * Channels of each sensor, in two kinds of entries:
+ *
+ * X(id, chan, group, key, deadband, flags, slide label, slide unit)
+ *	a reading taken by the sensor's acquisition job; `chan` is the
+ *	SENSOR_CHAN_* suffix for sensor API drivers
+ * D(id, group, key, deadband, flags, slide label, slide unit)
+ *	a value derived by the application after acquisition
+ *
+ * Channels with a slide label are shown on Ostentus, milli-unit channels with
+ * their unit. The order of X entries is the order of the job's readings.
+ */
+#define APP_MOISTURE_CHANNELS(X, D)                                                                \
+	X(MOISTURE_RAW, VOLTAGE, "moisture", "raw", DEADBAND_MOISTURE, 0, "Moisture Raw", "")      \
+	X(MOISTURE_FILTERED, VOLTAGE, "moisture", "filtered", DEADBAND_MOISTURE,                   \
+	  APP_CH_F_NO_STATS, NULL, NULL)                                                           \
+	D(MOISTURE_LEVEL, "moisture", "level", DEADBAND_MOISTURE,                                  \
+	  APP_CH_F_URGENT | APP_CH_F_NO_STATS, "Moisture Lvl", "")                                 \
+	D(MOISTURE_VWC, "moisture", "vwc", DEADBAND_VWC, APP_CH_F_MILLI, "Moisture VWC", "%")
+
+#define APP_LIGHT_CHANNELS(X, D)                                                                   \
+	X(LIGHT_INT, LIGHT, "light", "int", DEADBAND_LIGHT, 0, "Light Lvl", "")                    \
+	X(LIGHT_R, RED, "light", "r", DEADBAND_LIGHT, 0, NULL, NULL)                               \
+	X(LIGHT_G, GREEN, "light", "g", DEADBAND_LIGHT, 0, NULL, NULL)                             \
+	X(LIGHT_B, BLUE, "light", "b", DEADBAND_LIGHT, 0, NULL, NULL)
+
+#define APP_WEATHER_CHANNELS(X, D)                                                                 \
+	X(TEMP, AMBIENT_TEMP, "weather", "temp", DEADBAND_TEMP, APP_CH_F_MILLI, "Temperature",     \
+	  "C")                                                                                     \
+	X(PRESSURE, PRESS, "weather", "pressure", DEADBAND_PRESSURE, APP_CH_F_MILLI, "Pressure",   \
+	  "kPa")                                                                                   \
+	X(HUMIDITY, HUMIDITY, "weather", "humidity", DEADBAND_HUMIDITY, APP_CH_F_MILLI,            \
+	  "Humidity", "%RH")
+
+/*
+ * Motion is the number of motion interrupts; a new one is reported right away.
+ * With the FIFO, accel_p2p is the largest swing of an axis since the last read.
+ */
+#define APP_IMU_CHANNELS(X, D)                                                                     \
+	X(ACCEL_X, ACCEL_X, "imu", "accel_x", DEADBAND_ACCEL, APP_CH_F_MILLI, NULL, NULL)          \
+	X(ACCEL_Y, ACCEL_Y, "imu", "accel_y", DEADBAND_ACCEL, APP_CH_F_MILLI, NULL, NULL)          \
+	X(ACCEL_Z, ACCEL_Z, "imu", "accel_z", DEADBAND_ACCEL, APP_CH_F_MILLI, NULL, NULL)          \
+	IF_ENABLED(CONFIG_APP_IMU_FIFO,                                                            \
+		   (D(ACCEL_P2P, "imu", "accel_p2p", DEADBAND_ACCEL, APP_CH_F_MILLI, NULL, NULL)))  \
+	IF_ENABLED(CONFIG_APP_IMU_MOTION,                                                          \
+		   (D(MOTION, "imu", "motion", DEADBAND_ACCEL,                                     \
+		      APP_CH_F_URGENT | APP_CH_F_NO_STATS, NULL, NULL)))
+
+/**
+ * Every channel of the enabled sensors. The order matches the layout of the
+ * document streamed to Golioth (channels of the same group are encoded in one
+ * object) and the order of the Ostentus slides.
+ */
+#define APP_CHANNELS(X, D)                                                                         \
+	IF_ENABLED(APP_HAS_MOISTURE, (APP_MOISTURE_CHANNELS(X, D)))                                \
+	IF_ENABLED(APP_HAS_LIGHT, (APP_LIGHT_CHANNELS(X, D)))                                      \
+	IF_ENABLED(APP_HAS_WEATHER, (APP_WEATHER_CHANNELS(X, D)))                                  \
+	IF_ENABLED(APP_HAS_IMU, (APP_IMU_CHANNELS(X, D)))
+
+#define APP_CH_ENUM(id, ...) APP_CH_##id,
+
+/** Channels captured in each sample */
+enum app_channel {
+	APP_CHANNELS(APP_CH_ENUM, APP_CH_ENUM)
+	APP_CH_COUNT
+};
+
+BUILD_ASSERT(APP_CH_COUNT <= 32, "Sample mask has one bit per channel");
+
+struct app_channel_info {
+	/* Object in the stream document this channel belongs to */
+	const char *group;
+	/* Key of the channel inside its group */
+	const char *key;
+	/* Readings are in milli-units and streamed with a fractional part */
+	bool milli;
+	/* Minimum change reported, in the units of the reading */
+	enum app_deadband deadband;
+	/* Report any change immediately, regardless of deadband and batch size */
+	bool urgent;
+	/* Summarized in window statistics */
+	bool stats;
+	/* Ostentus slide of this channel, or NULL */
+	const char *slide_label;
+	const char *slide_unit;
+};
+
+extern const struct app_channel_info app_channels[APP_CH_COUNT];
+
+/** One set of sensor readings, captured at `uptime_ms` */
+struct app_sample {
+	int64_t uptime_ms;
+	/* Unix time of `uptime_ms` in ms, or 0 while no time base is available (see app_time.h) */
+	int64_t ts_ms;
+	/* Bit n is set when `val[n]` holds a reading that should be reported */
+	uint32_t mask;
+	/* Milli-units for `milli` channels (see app_fixed.h), counts otherwise */
+	int32_t val[APP_CH_COUNT];
+};
 
 void app_sensors_set_client(struct golioth_client *sensors_client);
-void app_sensors_read_and_stream(void);
+/** Read the sensors of `tasks`, a bitmask of enum app_task, and report them */
+void app_sensors_read_and_stream(uint32_t tasks);
 void sensor_init(void);
 
 /* Ostentus slide labels */
-#define M_READING_LABEL         "Moisture Raw"
-#define M_LEVEL_LABEL           "Moisture Lvl"
-#define M_LIGHT_INT_LABEL       "Light Lvl"
-#define M_TEMP_LABEL            "Temperature"
-#define M_PRESSURE_LABEL        "Pressure"
-#define M_HUMIDITY_LABEL        "Humidity"
 #define LABEL_BATTERY		"Battery"
 #define LABEL_FIRMWARE		"Firmware"
 #define SUMMARY_TITLE		"Soil Moisture"
 
 /**
- * Each Ostentus slide needs a unique key. You may add additional slides by
- * inserting elements with the name of your choice to this enum.
+ * Each Ostentus slide needs a unique key. Channels with a slide label use
+ * their channel number as the key; other slides are numbered after the last
+ * channel. You may add additional slides by inserting elements with the name
+ * of your choice to this enum.
  */
 typedef enum {
-	MOISTURE_READING_KEY,
-	MOISTURE_LEVEL_KEY,
-	MOISTURE_LIGHT_INT,
-	TEMPERATURE,
-	PRESSURE,
-	HUMIDITY,
 #ifdef CONFIG_ALUDEL_BATTERY_MONITOR
-	BATTERY_V,
+	BATTERY_V = APP_CH_COUNT,
 	BATTERY_PCT,
+	FIRMWARE,
+#else
+	FIRMWARE = APP_CH_COUNT,
 #endif
-	FIRMWARE
+	SLIDE_KEY_COUNT
 } slide_key;
 
 #endif /* __APP_SENSORS_H__ */
@@ -7,174 +7,534 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(app_settings, LOG_LEVEL_DBG);
 
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
 #include <golioth/client.h>
 #include <golioth/settings.h>
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/util.h>
 #include "main.h"
+#include "app_moisture.h"
+#include "app_sched.h"
 #include "app_settings.h"
 
-static int32_t _loop_delay_s = 60;
 #define LOOP_DELAY_S_MAX 43200
 #define LOOP_DELAY_S_MIN 1
 
+#define STREAM_BATCH_SIZE_MAX CONFIG_APP_STREAM_BATCH_MAX
+#define STREAM_BATCH_SIZE_MIN 1
+
+#define STREAM_MAX_AGE_S_MAX 86400
+#define STREAM_MAX_AGE_S_MIN 1
+
+#define STREAM_HEARTBEAT_S_MAX 86400
+#define STREAM_HEARTBEAT_S_MIN 1
+
+/* A window of 0 disables windowed statistics */
+#define STATS_WINDOW_S_MAX 86400
+#define STATS_WINDOW_S_MIN 0
+
+#define STATS_SAMPLE_S_MAX 3600
+#define STATS_SAMPLE_S_MIN 1
+
+#define DEADBAND_MAX 1000000
+#define DEADBAND_MIN 0
+
+/* A period of 0 follows LOOP_DELAY_S (see app_config_task_period_s()) */
+#define PERIOD_S_MAX 86400
+#define PERIOD_S_MIN 0
+
+/* Drift of the probe reading, in milli-counts/°C */
+#define VWC_TEMP_COEFF_MAX 100000
+#define VWC_TEMP_COEFF_MIN -100000
+
+/* Temperature the calibration curve was measured at */
+#define VWC_TEMP_REF_C_MAX 85
+#define VWC_TEMP_REF_C_MIN -40
+
 #define MIN_MOISTURE_VALUE 1
 #define MAX_MOISTURE_VALUE 5000
 
-static int32_t _MOISTURE_LEVEL_0 = 3400;
-static int32_t _MOISTURE_LEVEL_20 = 3200;
-static int32_t _MOISTURE_LEVEL_40 = 3000;
-static int32_t _MOISTURE_LEVEL_60 = 2800;
-static int32_t _MOISTURE_LEVEL_80 = 2600;
+/* Level reported for readings wetter than every threshold */
+#define MOISTURE_LEVEL_WET 100
+
+/*
+ * Deadband units are those of the streamed value scaled by 1000 for fractional
+ * channels (mm/s^2, m°C, Pa, m%RH, m% VWC) and raw counts for moisture and light.
+ */
+#define SETTINGS_DEFAULTS                                                                          \
+	{                                                                                          \
+		.version = 1,                                                                      \
+		.loop_delay_s = 60,                                                                \
+		.stream_batch_size = 5,                                                            \
+		.stream_max_age_s = 300,                                                           \
+		.stream_heartbeat_s = 3600,                                                        \
+		.stats_window_s = 0,                                                               \
+		.stats_sample_s = 10,                                                              \
+		.deadband = {                                                                      \
+			[DEADBAND_ACCEL] = 500,                                                    \
+			[DEADBAND_TEMP] = 200,                                                     \
+			[DEADBAND_PRESSURE] = 100,                                                 \
+			[DEADBAND_HUMIDITY] = 1000,                                                \
+			[DEADBAND_MOISTURE] = 10,                                                  \
+			[DEADBAND_LIGHT] = 10,                                                     \
+			[DEADBAND_VWC] = 500,                                                      \
+		},                                                                                 \
+		.moisture_threshold = {3400, 3200, 3000, 2800, 2600},                              \
+		.vwc_temp_ref_c = 25,                                                              \
+	}
+
+/* Level of each `moisture_threshold`, in the same order */
+static const uint8_t moisture_levels[APP_MOISTURE_LEVEL_COUNT] = {0, 20, 40, 60, 80};
+
+/* What a change of a setting affects, applied once per transaction */
+#define SETTING_WAKE BIT(0)
+#define SETTING_MOISTURE BIT(1)
+
+struct int_setting {
+	const char *key;
+	/* Offset of the value in struct app_config */
+	size_t offset;
+	int32_t min;
+	int32_t max;
+	uint32_t flags;
+};
+
+#define SETTING(_key, _field, _min, _max, _flags)                                                  \
+	{                                                                                          \
+		.key = _key, .offset = offsetof(struct app_config, _field), .min = _min,           \
+		.max = _max, .flags = _flags,                                                      \
+	}
+
+/* Every integer setting. Add an entry, and a field to struct app_config, to add one. */
+static const struct int_setting int_settings[] = {
+	SETTING("LOOP_DELAY_S", loop_delay_s, LOOP_DELAY_S_MIN, LOOP_DELAY_S_MAX, SETTING_WAKE),
+	SETTING("STREAM_BATCH_SIZE", stream_batch_size, STREAM_BATCH_SIZE_MIN,
+		STREAM_BATCH_SIZE_MAX, 0),
+	SETTING("STREAM_MAX_AGE_S", stream_max_age_s, STREAM_MAX_AGE_S_MIN, STREAM_MAX_AGE_S_MAX,
+		0),
+	SETTING("STREAM_HEARTBEAT_S", stream_heartbeat_s, STREAM_HEARTBEAT_S_MIN,
+		STREAM_HEARTBEAT_S_MAX, 0),
+	SETTING("STATS_WINDOW_S", stats_window_s, STATS_WINDOW_S_MIN, STATS_WINDOW_S_MAX,
+		SETTING_WAKE),
+	SETTING("STATS_SAMPLE_S", stats_sample_s, STATS_SAMPLE_S_MIN, STATS_SAMPLE_S_MAX,
+		SETTING_WAKE),
+	SETTING("DEADBAND_ACCEL", deadband[DEADBAND_ACCEL], DEADBAND_MIN, DEADBAND_MAX, 0),
+	SETTING("DEADBAND_TEMP", deadband[DEADBAND_TEMP], DEADBAND_MIN, DEADBAND_MAX, 0),
+	SETTING("DEADBAND_PRESSURE", deadband[DEADBAND_PRESSURE], DEADBAND_MIN, DEADBAND_MAX, 0),
+	SETTING("DEADBAND_HUMIDITY", deadband[DEADBAND_HUMIDITY], DEADBAND_MIN, DEADBAND_MAX, 0),
+	SETTING("DEADBAND_MOISTURE", deadband[DEADBAND_MOISTURE], DEADBAND_MIN, DEADBAND_MAX, 0),
+	SETTING("DEADBAND_LIGHT", deadband[DEADBAND_LIGHT], DEADBAND_MIN, DEADBAND_MAX, 0),
+	SETTING("DEADBAND_VWC", deadband[DEADBAND_VWC], DEADBAND_MIN, DEADBAND_MAX, 0),
+	SETTING("PERIOD_MOISTURE_S", period_s[APP_TASK_MOISTURE], PERIOD_S_MIN, PERIOD_S_MAX,
+		SETTING_WAKE),
+	SETTING("PERIOD_LIGHT_S", period_s[APP_TASK_LIGHT], PERIOD_S_MIN, PERIOD_S_MAX,
+		SETTING_WAKE),
+	SETTING("PERIOD_WEATHER_S", period_s[APP_TASK_WEATHER], PERIOD_S_MIN, PERIOD_S_MAX,
+		SETTING_WAKE),
+	SETTING("PERIOD_IMU_S", period_s[APP_TASK_IMU], PERIOD_S_MIN, PERIOD_S_MAX, SETTING_WAKE),
+	SETTING("PERIOD_BATTERY_S", period_s[APP_TASK_BATTERY], PERIOD_S_MIN, PERIOD_S_MAX,
+		SETTING_WAKE),
+	SETTING("PHASE_MOISTURE_S", phase_s[APP_TASK_MOISTURE], PERIOD_S_MIN, PERIOD_S_MAX,
+		SETTING_WAKE),
+	SETTING("PHASE_LIGHT_S", phase_s[APP_TASK_LIGHT], PERIOD_S_MIN, PERIOD_S_MAX, SETTING_WAKE),
+	SETTING("PHASE_WEATHER_S", phase_s[APP_TASK_WEATHER], PERIOD_S_MIN, PERIOD_S_MAX,
+		SETTING_WAKE),
+	SETTING("PHASE_IMU_S", phase_s[APP_TASK_IMU], PERIOD_S_MIN, PERIOD_S_MAX, SETTING_WAKE),
+	SETTING("PHASE_BATTERY_S", phase_s[APP_TASK_BATTERY], PERIOD_S_MIN, PERIOD_S_MAX,
+		SETTING_WAKE),
+	SETTING("MOISTURE_LEVEL_0", moisture_threshold[0], MIN_MOISTURE_VALUE,
+		MAX_MOISTURE_VALUE, SETTING_MOISTURE),
+	SETTING("MOISTURE_LEVEL_20", moisture_threshold[1], MIN_MOISTURE_VALUE,
+		MAX_MOISTURE_VALUE, SETTING_MOISTURE),
+	SETTING("MOISTURE_LEVEL_40", moisture_threshold[2], MIN_MOISTURE_VALUE,
+		MAX_MOISTURE_VALUE, SETTING_MOISTURE),
+	SETTING("MOISTURE_LEVEL_60", moisture_threshold[3], MIN_MOISTURE_VALUE,
+		MAX_MOISTURE_VALUE, SETTING_MOISTURE),
+	SETTING("MOISTURE_LEVEL_80", moisture_threshold[4], MIN_MOISTURE_VALUE,
+		MAX_MOISTURE_VALUE, SETTING_MOISTURE),
+	SETTING("VWC_TEMP_COEFF", vwc_temp_coeff, VWC_TEMP_COEFF_MIN, VWC_TEMP_COEFF_MAX, 0),
+	SETTING("VWC_TEMP_REF_C", vwc_temp_ref_c, VWC_TEMP_REF_C_MIN, VWC_TEMP_REF_C_MAX, 0),
+};
+
+/* The calibration curve is the only string setting; it is stored parsed */
+#define VWC_CALIBRATION_KEY "VWC_CALIBRATION"
 
+/*
+ * Settings are written to `staged` by the Golioth client thread, one key at a
+ * time, and copied to `config` once a burst of updates is over. `config` is
+ * only written in config_publish() and read in app_config_get().
+ */
+static struct app_config staged = SETTINGS_DEFAULTS;
+static struct app_config config = SETTINGS_DEFAULTS;
+/* Odd while `config` is being written */
+static atomic_t config_seq = ATOMIC_INIT(0);
+/* SETTING_* flags of the changes staged since the last publish */
+static uint32_t staged_flags;
+static K_MUTEX_DEFINE(staged_lock);
+
+static int32_t *setting_value(struct app_config *cfg, const struct int_setting *setting)
+{
+	return (int32_t *)((uint8_t *)cfg + setting->offset);
+}
+
+/* Copy `staged` to `config`. Call with staged_lock held. */
+static void config_publish(void)
+{
+	staged.version++;
+
+	/*
+	 * Readers retry while the sequence is odd or changed under them. The
+	 * scheduler lock keeps a higher priority reader from spinning on a
+	 * half-written snapshot while this thread is preempted.
+	 */
+	k_sched_lock();
+	atomic_inc(&config_seq);
+	memcpy(&config, &staged, sizeof(config));
+	atomic_inc(&config_seq);
+	k_sched_unlock();
+}
+
+void app_config_get(struct app_config *cfg)
+{
+	atomic_val_t seq;
+
+	do {
+		seq = atomic_get(&config_seq);
+		memcpy(cfg, &config, sizeof(*cfg));
+	} while ((seq & 1) || (seq != atomic_get(&config_seq)));
+}
+
+/* Single values are read straight from the snapshot; a word read is atomic */
 int32_t get_loop_delay_s(void)
 {
-	return _loop_delay_s;
+	return config.loop_delay_s;
 }
 
-int32_t get_moisture_level_threshold(uint32_t moisture_threshold)
+int32_t get_stream_batch_size(void)
 {
-	switch (moisture_threshold) {
-	case 0:
-		return _MOISTURE_LEVEL_0;
-		break;
+	return config.stream_batch_size;
+}
+
+int32_t get_stream_max_age_s(void)
+{
+	return config.stream_max_age_s;
+}
 
-	case 20:
-		return _MOISTURE_LEVEL_20;
-		break;
+int32_t get_stream_heartbeat_s(void)
+{
+	return config.stream_heartbeat_s;
+}
 
-	case 40:
-		return _MOISTURE_LEVEL_40;
-		break;
+int32_t get_stats_window_s(void)
+{
+	return config.stats_window_s;
+}
 
-	case 60:
-		return _MOISTURE_LEVEL_60;
-		break;
+int32_t get_stats_sample_s(void)
+{
+	return config.stats_sample_s;
+}
 
-	case 80:
-		return _MOISTURE_LEVEL_80;
-		break;
+int32_t get_deadband(enum app_deadband deadband)
+{
+	return config.deadband[deadband];
+}
 
-	default:
-		LOG_ERR("Passed invalid value to get_moisture_level() function");
-		return -ENOTSUP;
-		break;
+int32_t app_config_task_period_s(const struct app_config *cfg, enum app_task task)
+{
+	if (cfg->period_s[task]) {
+		return cfg->period_s[task];
 	}
+
+	return cfg->stats_window_s ? cfg->stats_sample_s : cfg->loop_delay_s;
 }
 
-static enum golioth_settings_status on_loop_delay_setting(int32_t new_value, void *arg)
+void app_settings_moisture_classifier_build(const struct app_config *cfg)
 {
-	_loop_delay_s = new_value;
-	LOG_INF("Set loop delay to %i seconds", new_value);
-	wake_system_thread();
-	return GOLIOTH_SETTINGS_SUCCESS;
+	struct moisture_band bands[APP_MOISTURE_LEVEL_COUNT];
+
+	for (int i = 0; i < APP_MOISTURE_LEVEL_COUNT; i++) {
+		bands[i].threshold = cfg->moisture_threshold[i];
+		bands[i].level = moisture_levels[i];
+	}
+
+	moisture_classifier_build(bands, ARRAY_SIZE(bands), MOISTURE_LEVEL_WET);
 }
 
-static enum golioth_settings_status on_moisture_level_setting(int32_t new_value, void *arg)
-{
-	intptr_t m_level = (intptr_t) arg;
-	int32_t *stored_value;
-
-	switch (m_level) {
-		case 0:
-			stored_value = &_MOISTURE_LEVEL_0;
-			break;
-		case 20:
-			stored_value = &_MOISTURE_LEVEL_20;
-			break;
-		case 40:
-			stored_value = &_MOISTURE_LEVEL_40;
-			break;
-		case 60:
-			stored_value = &_MOISTURE_LEVEL_60;
-			break;
-		case 80:
-			stored_value = &_MOISTURE_LEVEL_80;
-			break;
-		default:
-			return GOLIOTH_SETTINGS_GENERAL_ERROR;
-
-	}
-
-	/* Only update if value has changed */
-	if (*stored_value == new_value) {
-		LOG_DBG("Received MOISTURE_LEVEL_%li already matches local value.", m_level);
-	} else {
-		*stored_value = new_value;
-		LOG_INF("Set Moisture Level %li to %d", m_level, *stored_value);
-		wake_system_thread();
+#ifdef CONFIG_APP_SETTINGS_PERSIST
+
+/* Accepted values are kept in flash as "app/<KEY>" */
+#define PERSIST_SUBTREE "app"
+#define PERSIST_PATH_LEN 48
+
+/* Values in flash, or the defaults; only used by the persist work */
+static struct app_config saved = SETTINGS_DEFAULTS;
+
+static void persist_work_handler(struct k_work *work)
+{
+	struct app_config cfg;
+	char path[PERSIST_PATH_LEN];
+	int32_t value;
+	int count = 0;
+	int err;
+
+	app_config_get(&cfg);
+
+	for (int i = 0; i < ARRAY_SIZE(int_settings); i++) {
+		value = *setting_value(&cfg, &int_settings[i]);
+		if (value == *setting_value(&saved, &int_settings[i])) {
+			continue;
+		}
+
+		snprintf(path, sizeof(path), PERSIST_SUBTREE "/%s", int_settings[i].key);
+
+		err = settings_save_one(path, &value, sizeof(value));
+		if (err) {
+			LOG_ERR("Failed to save %s: %d", int_settings[i].key, err);
+			continue;
+		}
+
+		*setting_value(&saved, &int_settings[i]) = value;
+		count++;
 	}
 
-	return GOLIOTH_SETTINGS_SUCCESS;
+	if (memcmp(&cfg.vwc_curve, &saved.vwc_curve, sizeof(cfg.vwc_curve)) != 0) {
+		err = settings_save_one(PERSIST_SUBTREE "/" VWC_CALIBRATION_KEY, &cfg.vwc_curve,
+					sizeof(cfg.vwc_curve));
+		if (err) {
+			LOG_ERR("Failed to save %s: %d", VWC_CALIBRATION_KEY, err);
+		} else {
+			saved.vwc_curve = cfg.vwc_curve;
+			count++;
+		}
+	}
+
+	LOG_DBG("Saved %d settings", count);
 }
+static K_WORK_DELAYABLE_DEFINE(persist_work, persist_work_handler);
 
-int app_settings_register(struct golioth_client *client)
+static const struct int_setting *setting_find(const char *key)
+{
+	for (int i = 0; i < ARRAY_SIZE(int_settings); i++) {
+		if (strcmp(key, int_settings[i].key) == 0) {
+			return &int_settings[i];
+		}
+	}
+
+	return NULL;
+}
+
+static int persist_restore_vwc_curve(size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+	struct vwc_curve curve;
+	int ret;
+
+	/* The size changes with CONFIG_APP_VWC_POINTS_MAX */
+	if (len != sizeof(curve)) {
+		LOG_WRN("Ignoring stored %s", VWC_CALIBRATION_KEY);
+		return 0;
+	}
+
+	ret = read_cb(cb_arg, &curve, sizeof(curve));
+	if (ret < 0) {
+		LOG_ERR("Failed to read stored %s: %d", VWC_CALIBRATION_KEY, ret);
+		return ret;
+	}
+
+	if (vwc_curve_check(&curve)) {
+		LOG_WRN("Stored %s is not valid", VWC_CALIBRATION_KEY);
+		return 0;
+	}
+
+	staged.vwc_curve = curve;
+	saved.vwc_curve = curve;
+	LOG_INF("Restored %s with %u points", VWC_CALIBRATION_KEY, curve.count);
+
+	return 0;
+}
+
+/* Called by settings_load_subtree() with staged_lock held */
+static int persist_restore(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+	const struct int_setting *setting = setting_find(key);
+	int32_t value;
+	int ret;
+
+	if (strcmp(key, VWC_CALIBRATION_KEY) == 0) {
+		return persist_restore_vwc_curve(len, read_cb, cb_arg);
+	}
+
+	if (!setting || (len != sizeof(value))) {
+		LOG_WRN("Ignoring stored setting %s", key);
+		return 0;
+	}
+
+	ret = read_cb(cb_arg, &value, sizeof(value));
+	if (ret < 0) {
+		LOG_ERR("Failed to read stored %s: %d", key, ret);
+		return ret;
+	}
+
+	/* The range may have changed with a firmware update */
+	if ((value < setting->min) || (value > setting->max)) {
+		LOG_WRN("Stored %s out of range: %d", key, value);
+		return 0;
+	}
+
+	*setting_value(&staged, setting) = value;
+	*setting_value(&saved, setting) = value;
+	LOG_INF("Restored %s = %d", key, value);
+
+	return 0;
+}
+
+static struct settings_handler persist_handler = {
+	.name = PERSIST_SUBTREE,
+	.h_set = persist_restore,
+};
+
+int app_settings_load(void)
 {
-	struct golioth_settings *settings = golioth_settings_init(client);
 	int err;
 
-	err = golioth_settings_register_int_with_range(settings,
-						       "LOOP_DELAY_S",
-						       LOOP_DELAY_S_MIN,
-						       LOOP_DELAY_S_MAX,
-						       on_loop_delay_setting,
-						       NULL);
+	err = settings_subsys_init();
+	if (err) {
+		LOG_ERR("Failed to initialize settings storage: %d", err);
+		return err;
+	}
 
+	err = settings_register(&persist_handler);
 	if (err) {
-		LOG_ERR("Failed to register LOOP_DELAY_S settings callback: %d", err);
+		LOG_ERR("Failed to register settings handler: %d", err);
+		return err;
 	}
 
-	err = golioth_settings_register_int_with_range(settings,
-						       "MOISTURE_LEVEL_0",
-						       MIN_MOISTURE_VALUE,
-						       MAX_MOISTURE_VALUE,
-						       on_moisture_level_setting,
-						       (void *) 0);
+	k_mutex_lock(&staged_lock, K_FOREVER);
+	err = settings_load_subtree(PERSIST_SUBTREE);
+	config_publish();
+	k_mutex_unlock(&staged_lock);
 
-	if (err) {
-		LOG_ERR("Failed to register MOISTURE_LEVEL_0 settings callback: %d", err);
+	return err;
+}
+
+#endif /* CONFIG_APP_SETTINGS_PERSIST */
+
+/* Publish the staged settings once no more arrived for CONFIG_APP_SETTINGS_COMMIT_MS */
+static void commit_work_handler(struct k_work *work)
+{
+	uint32_t flags;
+	uint32_t version;
+
+	k_mutex_lock(&staged_lock, K_FOREVER);
+	flags = staged_flags;
+	staged_flags = 0;
+	config_publish();
+	version = staged.version;
+	k_mutex_unlock(&staged_lock);
+
+	LOG_INF("Applied settings version %u", version);
+
+	/* One wake-up for the whole transaction */
+	if (flags & SETTING_MOISTURE) {
+		app_sched_request(BIT(APP_TASK_MOISTURE));
+	} else if (flags & SETTING_WAKE) {
+		wake_system_thread();
 	}
 
-	err = golioth_settings_register_int_with_range(settings,
-						       "MOISTURE_LEVEL_20",
-						       MIN_MOISTURE_VALUE,
-						       MAX_MOISTURE_VALUE,
-						       on_moisture_level_setting,
-						       (void *) 20);
+	IF_ENABLED(CONFIG_APP_SETTINGS_PERSIST, (
+		/* Flash writes wait for the changes to settle */
+		k_work_reschedule(&persist_work, K_SECONDS(CONFIG_APP_SETTINGS_SAVE_DELAY_S));
+	));
+}
+static K_WORK_DELAYABLE_DEFINE(commit_work, commit_work_handler);
 
-	if (err) {
-		LOG_ERR("Failed to register MOISTURE_LEVEL_20 settings callback: %d", err);
+static enum golioth_settings_status on_int_setting(int32_t new_value, void *arg)
+{
+	const struct int_setting *setting = arg;
+	int32_t *value;
+	bool changed;
+
+	k_mutex_lock(&staged_lock, K_FOREVER);
+	value = setting_value(&staged, setting);
+	changed = (*value != new_value);
+	if (changed) {
+		*value = new_value;
+		staged_flags |= setting->flags;
+	}
+	k_mutex_unlock(&staged_lock);
+
+	if (!changed) {
+		LOG_DBG("Received %s already matches local value.", setting->key);
+		return GOLIOTH_SETTINGS_SUCCESS;
 	}
 
-	err = golioth_settings_register_int_with_range(settings,
-						       "MOISTURE_LEVEL_40",
-						       MIN_MOISTURE_VALUE,
-						       MAX_MOISTURE_VALUE,
-						       on_moisture_level_setting,
-						       (void *) 40);
+	LOG_INF("Set %s to %d", setting->key, new_value);
+
+	/* Settings are delivered one key at a time; apply them together */
+	k_work_reschedule(&commit_work, K_MSEC(CONFIG_APP_SETTINGS_COMMIT_MS));
 
+	return GOLIOTH_SETTINGS_SUCCESS;
+}
+
+static enum golioth_settings_status on_vwc_calibration(const char *new_value, size_t len,
+							void *arg)
+{
+	struct vwc_curve curve;
+	bool changed;
+	int err;
+
+	/* Parsed here so a bad curve is rejected back to Golioth, never applied */
+	err = vwc_curve_parse(&curve, new_value, len);
 	if (err) {
-		LOG_ERR("Failed to register MOISTURE_LEVEL_40 settings callback: %d", err);
+		LOG_ERR("Invalid %s: %d", VWC_CALIBRATION_KEY, err);
+		return GOLIOTH_SETTINGS_VALUE_FORMAT_NOT_VALID;
 	}
 
-	err = golioth_settings_register_int_with_range(settings,
-						       "MOISTURE_LEVEL_60",
-						       MIN_MOISTURE_VALUE,
-						       MAX_MOISTURE_VALUE,
-						       on_moisture_level_setting,
-						       (void *) 60);
+	k_mutex_lock(&staged_lock, K_FOREVER);
+	changed = (memcmp(&staged.vwc_curve, &curve, sizeof(curve)) != 0);
+	if (changed) {
+		staged.vwc_curve = curve;
+	}
+	k_mutex_unlock(&staged_lock);
 
-	if (err) {
-		LOG_ERR("Failed to register MOISTURE_LEVEL_60 settings callback: %d", err);
+	if (!changed) {
+		LOG_DBG("Received %s already matches local value.", VWC_CALIBRATION_KEY);
+		return GOLIOTH_SETTINGS_SUCCESS;
 	}
 
-	err = golioth_settings_register_int_with_range(settings,
-						       "MOISTURE_LEVEL_80",
-						       MIN_MOISTURE_VALUE,
-						       MAX_MOISTURE_VALUE,
-						       on_moisture_level_setting,
-						       (void *) 80);
+	LOG_INF("Set %s with %u points", VWC_CALIBRATION_KEY, curve.count);
+
+	k_work_reschedule(&commit_work, K_MSEC(CONFIG_APP_SETTINGS_COMMIT_MS));
+
+	return GOLIOTH_SETTINGS_SUCCESS;
+}
+
+int app_settings_register(struct golioth_client *client)
+{
+	struct golioth_settings *settings = golioth_settings_init(client);
+	int err;
+
+	for (int i = 0; i < ARRAY_SIZE(int_settings); i++) {
+		err = golioth_settings_register_int_with_range(settings,
+							       int_settings[i].key,
+							       int_settings[i].min,
+							       int_settings[i].max,
+							       on_int_setting,
+							       (void *)&int_settings[i]);
+
+		if (err) {
+			LOG_ERR("Failed to register %s settings callback: %d",
+				int_settings[i].key, err);
+		}
+	}
 
+	err = golioth_settings_register_string(settings, VWC_CALIBRATION_KEY, on_vwc_calibration,
+					       NULL);
 	if (err) {
-		LOG_ERR("Failed to register MOISTURE_LEVEL_80 settings callback: %d", err);
+		LOG_ERR("Failed to register %s settings callback: %d", VWC_CALIBRATION_KEY, err);
 	}
 
 	return 0;
@@ -10,7 +10,31 @@
  *
  * In this demonstration, the device looks for the `LOOP_DELAY_S` key from the
  * Settings Service and uses this value to determine the delay between sensor
- * reads (the period of sleep in the loop of `main.c`.
+ * reads.
+ *
+ * `STREAM_BATCH_SIZE` and `STREAM_MAX_AGE_S` control how many samples are
+ * grouped into one LightDB Stream upload, and how long a sample may wait in
+ * the buffer before a partial batch is sent (see app_stream.h).
+ *
+ * Readings are only uploaded when they move by more than their `DEADBAND_*`
+ * setting since they were last reported, or every `STREAM_HEARTBEAT_S`.
+ *
+ * `PERIOD_*_S` give a sensor its own period instead (see app_sched.h); a
+ * period of 0, the default, keeps it on `LOOP_DELAY_S`.
+ *
+ * `VWC_CALIBRATION` is a string holding the calibration curve of the moisture
+ * probe, and `VWC_TEMP_COEFF` and `VWC_TEMP_REF_C` its temperature
+ * compensation (see app_vwc.h).
+ *
+ * Golioth delivers settings one key at a time. Keys received within
+ * `CONFIG_APP_SETTINGS_COMMIT_MS` of each other are applied together as a new
+ * `struct app_config` snapshot, which wakes the sensor loop once. The sensor
+ * loop copies the snapshot once per cycle with `app_config_get()`, without
+ * taking a lock, so a cycle never sees half of an update.
+ *
+ * With `CONFIG_APP_SETTINGS_PERSIST`, accepted values are saved to the
+ * settings storage in flash, a few seconds after the last change, and
+ * restored at boot before the Settings Service is reachable.
  *
  * https://docs.golioth.io/firmware/zephyr-device-sdk/device-settings-service
  */
@@ -21,8 +45,75 @@
 #include <stdint.h>
 #include <golioth/client.h>
 
+#include "app_sched.h"
+#include "app_vwc.h"
+
+/** Channel groups sharing one `DEADBAND_*` setting */
+enum app_deadband {
+	DEADBAND_ACCEL,
+	DEADBAND_TEMP,
+	DEADBAND_PRESSURE,
+	DEADBAND_HUMIDITY,
+	DEADBAND_MOISTURE,
+	DEADBAND_LIGHT,
+	DEADBAND_VWC,
+	DEADBAND_COUNT
+};
+
+/* Number of `MOISTURE_LEVEL_*` thresholds */
+#define APP_MOISTURE_LEVEL_COUNT 5
+
+/** Value of every setting, as published by the last settings transaction */
+struct app_config {
+	/* Incremented with each published snapshot */
+	uint32_t version;
+	int32_t loop_delay_s;
+	int32_t stream_batch_size;
+	int32_t stream_max_age_s;
+	int32_t stream_heartbeat_s;
+	int32_t stats_window_s;
+	int32_t stats_sample_s;
+	int32_t deadband[DEADBAND_COUNT];
+	/* 0 to follow the shared period, see app_config_task_period_s() */
+	int32_t period_s[APP_TASK_COUNT];
+	/* Offset of each task's schedule from boot (see app_sched.h) */
+	int32_t phase_s[APP_TASK_COUNT];
+	/* `MOISTURE_LEVEL_0` to `MOISTURE_LEVEL_80` */
+	int32_t moisture_threshold[APP_MOISTURE_LEVEL_COUNT];
+	/* `VWC_CALIBRATION`; empty when the probe is not calibrated */
+	struct vwc_curve vwc_curve;
+	/* `VWC_TEMP_COEFF` in milli-counts/°C and `VWC_TEMP_REF_C` */
+	int32_t vwc_temp_coeff;
+	int32_t vwc_temp_ref_c;
+};
+
+/** Copy the current snapshot; lock-free, may be called from any thread */
+void app_config_get(struct app_config *cfg);
+
+/** Period of `task` in seconds, after resolving the shared default */
+int32_t app_config_task_period_s(const struct app_config *cfg, enum app_task task);
+
 int32_t get_loop_delay_s(void);
+int32_t get_stream_batch_size(void);
+int32_t get_stream_max_age_s(void);
+int32_t get_stream_heartbeat_s(void);
+int32_t get_stats_window_s(void);
+int32_t get_stats_sample_s(void);
+int32_t get_deadband(enum app_deadband deadband);
 int app_settings_register(struct golioth_client *client);
-int32_t get_moisture_level_threshold(uint32_t moisture_threshold);
+
+/**
+ * Build the moisture classification table from the `MOISTURE_LEVEL_*`
+ * thresholds of a snapshot. Only the sensor loop classifies readings, so it
+ * rebuilds the table itself when it sees a new snapshot.
+ */
+void app_settings_moisture_classifier_build(const struct app_config *cfg);
+
+/**
+ * Restore the values last accepted from the Settings Service, so the device
+ * starts with them instead of the compiled-in defaults. Call before the
+ * sensors are initialized.
+ */
+int app_settings_load(void);
 
 #endif /* __APP_SETTINGS_H__ */
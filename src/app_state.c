@@ -7,163 +7,667 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(app_state, LOG_LEVEL_DBG);
 
+#include <errno.h>
+#include <string.h>
 #include <golioth/client.h>
 #include <golioth/lightdb_state.h>
-#include <zephyr/data/json.h>
 #include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#ifdef CONFIG_APP_STATE_ENCODING_CBOR
+#include <zcbor_decode.h>
+#include <zcbor_encode.h>
+#endif
+#ifdef CONFIG_APP_STATE_PARSE_COMPARE
 #include "json_helper.h"
+#endif
 
+#include "app_json.h"
+#include "app_prof.h"
 #include "app_state.h"
 #include "app_sensors.h"
 
-#define DEVICE_STATE_FMT "{\"example_int0\":%d,\"example_int1\":%d}"
-
-uint32_t _example_int0;
-uint32_t _example_int1 = 1;
+/*
+ * Every state field, as X(name, min, max, default, apply):
+ *
+ * A field is an int32 found under `name` in both endpoints. Desired values
+ * outside [min, max] are rejected. `apply`, if not NULL, is called with the
+ * new value each time a desired value changes the field.
+ */
+#define APP_STATE_FIELDS(X)                                                                        \
+	X(example_int0, 0, 65535, 0, NULL)                                                         \
+	X(example_int1, 0, 65535, 1, NULL)
+
+struct state_field {
+	const char *name;
+	int32_t min;
+	int32_t max;
+	void (*apply)(int32_t value);
+};
+
+#define STATE_FIELD_ENUM(_name, ...) STATE_FIELD_##_name,
+#define STATE_FIELD_INFO(_name, _min, _max, _def, _apply)                                          \
+	{.name = #_name, .min = _min, .max = _max, .apply = _apply},
+#define STATE_FIELD_DEFAULT(_name, _min, _max, _def, _apply) [STATE_FIELD_##_name] = _def,
+
+enum state_field_id {
+	APP_STATE_FIELDS(STATE_FIELD_ENUM)
+	STATE_FIELD_COUNT
+};
+
+BUILD_ASSERT(STATE_FIELD_COUNT <= 32, "Desired values are tracked in a 32-bit mask");
+
+static const struct state_field state_fields[STATE_FIELD_COUNT] = {
+	APP_STATE_FIELDS(STATE_FIELD_INFO)
+};
+
+struct state_values {
+	int32_t val[STATE_FIELD_COUNT];
+};
+
+/* Fields found in a desired payload */
+struct state_desired {
+	int32_t val[STATE_FIELD_COUNT];
+	/* Fields present in the payload */
+	uint32_t present;
+	/* Present fields whose value is not an integer */
+	uint32_t invalid;
+};
+
+/* Large enough for every field with a 10 digit value and its sign */
+#define STATE_PAYLOAD_MAX_LEN (16 + (STATE_FIELD_COUNT * 48))
+
+/* Delay before a failed write is sent again */
+#define STATE_RETRY_S 30
+
+/* Value the cloud writes, and the device resets desired values to, for "no change" */
+#define STATE_NO_CHANGE -1
+
+#ifdef CONFIG_APP_STATE_ENCODING_CBOR
+#define STATE_CONTENT_TYPE GOLIOTH_CONTENT_TYPE_CBOR
+#else
+#define STATE_CONTENT_TYPE GOLIOTH_CONTENT_TYPE_JSON
+#endif
 
 static struct golioth_client *client;
 
-static void async_handler(struct golioth_client *client,
-			  enum golioth_status status,
-			  const struct golioth_coap_rsp_code *coap_rsp_code,
-			  const char *path,
-			  void *arg)
+/*
+ * Local shadow of the state endpoints. Desired changes are applied to
+ * `actual` right away and written to the server by flush_work, once they
+ * stopped arriving for CONFIG_APP_STATE_FLUSH_MS. Only one write per endpoint
+ * is in flight at a time, so `acked` is what the server holds.
+ */
+static K_MUTEX_DEFINE(state_lock);
+static struct state_values actual = {{APP_STATE_FIELDS(STATE_FIELD_DEFAULT)}};
+/* Incremented with every change of `actual` */
+static uint32_t actual_version;
+/* Content and version of the write to the actual endpoint in flight */
+static struct state_values sent;
+static uint32_t sent_version;
+static bool actual_in_flight;
+/* Content of the actual endpoint acknowledged by the server */
+static struct state_values acked;
+static bool acked_valid;
+/* Desired values were processed and must be reset to STATE_NO_CHANGE */
+static bool desired_reset_pending;
+static bool desired_reset_in_flight;
+
+static void flush_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(flush_work, flush_work_handler);
+
+static const struct state_field *state_field_find(const uint8_t *key, size_t len, int *id)
 {
-	if (status != GOLIOTH_OK) {
-		LOG_WRN("Failed to set state: %d", status);
+	for (int i = 0; i < STATE_FIELD_COUNT; i++) {
+		const char *name = state_fields[i].name;
+
+		if ((strlen(name) == len) && (memcmp(name, key, len) == 0)) {
+			*id = i;
+			return &state_fields[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void state_desired_set(struct state_desired *desired, int id, int64_t value,
+			      bool integral)
+{
+	desired->present |= BIT(id);
+
+	if (!integral || (value < INT32_MIN) || (value > INT32_MAX)) {
+		desired->invalid |= BIT(id);
 		return;
 	}
 
-	LOG_DBG("State successfully set");
+	desired->val[id] = (int32_t)value;
 }
 
-int app_state_reset_desired(void)
+#ifdef CONFIG_APP_STATE_ENCODING_CBOR
+
+/* Decode a map of the desired fields; other keys and nested values are skipped */
+static int state_parse(const uint8_t *payload, size_t len, struct state_desired *desired)
 {
-	LOG_INF("Resetting \"%s\" LightDB State endpoint to defaults.", APP_STATE_DESIRED_ENDP);
+	ZCBOR_STATE_D(zsd, 2, payload, len, 1, 0);
+	struct zcbor_string key;
+	int64_t value;
+	double fvalue;
+	int id;
+
+	if (!zcbor_map_start_decode(zsd)) {
+		return -EBADMSG;
+	}
 
-	char sbuf[sizeof(DEVICE_STATE_FMT) + 4]; /* space for two "-1" values */
+	while (!zcbor_array_at_end(zsd)) {
+		if (!zcbor_tstr_decode(zsd, &key)) {
+			return -EBADMSG;
+		}
 
-	snprintk(sbuf, sizeof(sbuf), DEVICE_STATE_FMT, -1, -1);
+		if (!state_field_find(key.value, key.len, &id)) {
+			if (!zcbor_any_skip(zsd, NULL)) {
+				return -EBADMSG;
+			}
+			continue;
+		}
 
-	int err;
+		/* Whole numbers may come as floats */
+		if (zcbor_int64_decode(zsd, &value)) {
+			state_desired_set(desired, id, value, true);
+		} else if (zcbor_float_decode(zsd, &fvalue)) {
+			bool integral = (fvalue >= INT32_MIN) && (fvalue <= INT32_MAX) &&
+					(fvalue == (int32_t)fvalue);
 
-	err = golioth_lightdb_set_async(client,
-					APP_STATE_DESIRED_ENDP,
-					GOLIOTH_CONTENT_TYPE_JSON,
-					sbuf,
-					strlen(sbuf),
-					async_handler,
-					NULL);
+			state_desired_set(desired, id, integral ? (int32_t)fvalue : 0, integral);
+		} else if (zcbor_any_skip(zsd, NULL)) {
+			state_desired_set(desired, id, 0, false);
+		} else {
+			return -EBADMSG;
+		}
+	}
+
+	if (!zcbor_map_end_decode(zsd)) {
+		return -EBADMSG;
+	}
+
+	return 0;
+}
+
+static int state_encode(const struct state_values *values, uint8_t *buf, size_t len)
+{
+	ZCBOR_STATE_E(zse, 1, buf, len, 1);
+	bool ok;
+
+	ok = zcbor_map_start_encode(zse, STATE_FIELD_COUNT);
+
+	for (int i = 0; ok && (i < STATE_FIELD_COUNT); i++) {
+		ok = zcbor_tstr_encode_ptr(zse, state_fields[i].name,
+					   strlen(state_fields[i].name)) &&
+		     zcbor_int32_put(zse, values->val[i]);
+	}
+
+	ok = ok && zcbor_map_end_encode(zse, STATE_FIELD_COUNT);
+	if (!ok) {
+		return -ENOMEM;
+	}
+
+	return zse->payload - buf;
+}
+
+#else /* CONFIG_APP_STATE_ENCODING_JSON */
+
+/*
+ * A flat JSON object is scanned in place: keys and numbers are compared and
+ * converted straight from the payload, which is never written or copied.
+ */
+
+static const uint8_t *json_skip_ws(const uint8_t *p, const uint8_t *end)
+{
+	while ((p < end) && ((*p == ' ') || (*p == '\t') || (*p == '\n') || (*p == '\r'))) {
+		p++;
+	}
+
+	return p;
+}
+
+/* Span of a string without its quotes; escapes are kept as they are */
+static const uint8_t *json_string(const uint8_t *p, const uint8_t *end, const uint8_t **str,
+				  size_t *len)
+{
+	if ((p == end) || (*p != '"')) {
+		return NULL;
+	}
+
+	*str = ++p;
+
+	for (; p < end; p++) {
+		if (*p == '\\') {
+			p++;
+		} else if (*p == '"') {
+			*len = p - *str;
+			return p + 1;
+		}
+	}
+
+	return NULL;
+}
+
+/* Skip any value, including nested objects and arrays, up to the next member */
+static const uint8_t *json_skip_value(const uint8_t *p, const uint8_t *end)
+{
+	const uint8_t *str;
+	size_t len;
+	int depth = 0;
+
+	while (p < end) {
+		if (*p == '"') {
+			p = json_string(p, end, &str, &len);
+			if (!p) {
+				return NULL;
+			}
+			continue;
+		}
+
+		if ((depth == 0) && ((*p == ',') || (*p == '}') || (*p == ']'))) {
+			return p;
+		}
+
+		if ((*p == '{') || (*p == '[')) {
+			depth++;
+		} else if ((*p == '}') || (*p == ']')) {
+			depth--;
+		}
+		p++;
+	}
+
+	return NULL;
+}
+
+/* Integer value; anything else, such as 1.5 or "1", is skipped and not integral */
+static const uint8_t *json_int(const uint8_t *p, const uint8_t *end, int64_t *value,
+			       bool *integral)
+{
+	const uint8_t *start = p;
+	bool neg = false;
+	int64_t v = 0;
+
+	if ((p < end) && (*p == '-')) {
+		neg = true;
+		p++;
+	}
+
+	for (; (p < end) && (*p >= '0') && (*p <= '9'); p++) {
+		/* Saturate; anything this large is out of range anyway */
+		v = MIN((v * 10) + (*p - '0'), (int64_t)INT32_MAX + 1);
+	}
+
+	*value = neg ? -v : v;
+	*integral = (p > start + neg) && ((p == end) || (*p == ',') || (*p == '}') ||
+					  (*p == ' ') || (*p == '\t') || (*p == '\n') ||
+					  (*p == '\r'));
+	if (*integral) {
+		return p;
+	}
+
+	return json_skip_value(start, end);
+}
+
+static int state_parse(const uint8_t *payload, size_t len, struct state_desired *desired)
+{
+	const uint8_t *end = payload + len;
+	const uint8_t *p = json_skip_ws(payload, end);
+	const uint8_t *key;
+	size_t key_len;
+	bool integral;
+	int64_t value;
+	int id;
+
+	if ((p == end) || (*p++ != '{')) {
+		return -EBADMSG;
+	}
+
+	p = json_skip_ws(p, end);
+	if ((p < end) && (*p == '}')) {
+		return 0;
+	}
+
+	while (p < end) {
+		p = json_string(p, end, &key, &key_len);
+		p = p ? json_skip_ws(p, end) : NULL;
+		if (!p || (p == end) || (*p++ != ':')) {
+			return -EBADMSG;
+		}
+
+		p = json_skip_ws(p, end);
+
+		if (state_field_find(key, key_len, &id)) {
+			p = json_int(p, end, &value, &integral);
+			state_desired_set(desired, id, value, integral);
+		} else {
+			p = json_skip_value(p, end);
+		}
+
+		p = p ? json_skip_ws(p, end) : NULL;
+		if (!p || (p == end)) {
+			return -EBADMSG;
+		}
+
+		if (*p == '}') {
+			return 0;
+		}
+
+		if (*p++ != ',') {
+			return -EBADMSG;
+		}
+
+		p = json_skip_ws(p, end);
+	}
+
+	return -EBADMSG;
+}
+
+static int state_encode(const struct state_values *values, uint8_t *buf, size_t len)
+{
+	size_t pos = 0;
+	int err = 0;
+
+	for (int i = 0; !err && (i < STATE_FIELD_COUNT); i++) {
+		err = app_json_append((char *)buf, len, &pos, "%s\"%s\":%d",
+				      (i == 0) ? "{" : ",", state_fields[i].name, values->val[i]);
+	}
+
+	err = err ? err : app_json_append((char *)buf, len, &pos, "}");
 	if (err) {
-		LOG_ERR("Unable to write to LightDB State: %d", err);
+		return err;
 	}
-	return err;
+
+	return pos;
 }
 
-int app_state_update_actual(void)
+#endif /* CONFIG_APP_STATE_ENCODING_CBOR */
+
+#ifdef CONFIG_APP_STATE_PARSE_COMPARE
+/* json_obj_parse() tokenizes in place, so it is given a copy */
+static char compare_buf[STATE_PAYLOAD_MAX_LEN];
+
+static void state_parse_compare(const uint8_t *payload, size_t len)
 {
+	struct state_desired desired = {0};
+	struct app_state parsed_state;
+	uint32_t table_cycles;
+	uint32_t start;
+	int ret;
+
+	if (len > sizeof(compare_buf)) {
+		return;
+	}
 
-	char sbuf[sizeof(DEVICE_STATE_FMT) + 10]; /* space for uint16 values */
+	start = k_cycle_get_32();
+	state_parse(payload, len, &desired);
+	table_cycles = k_cycle_get_32() - start;
 
-	snprintk(sbuf, sizeof(sbuf), DEVICE_STATE_FMT, _example_int0, _example_int1);
+	memcpy(compare_buf, payload, len);
 
+	start = k_cycle_get_32();
+	ret = json_obj_parse(compare_buf, len, app_state_descr, ARRAY_SIZE(app_state_descr),
+			     &parsed_state);
+
+	LOG_INF("Desired parse: table %u us, json_obj_parse %u us (%d)",
+		k_cyc_to_us_floor32(table_cycles),
+		k_cyc_to_us_floor32(k_cycle_get_32() - start), ret);
+}
+#endif
+
+static int state_write(const char *path, const struct state_values *values,
+		       golioth_set_cb_fn cb)
+{
+	uint8_t buf[STATE_PAYLOAD_MAX_LEN];
+	uint32_t start = app_prof_start();
+	int len;
 	int err;
 
+	len = state_encode(values, buf, sizeof(buf));
+	app_prof_record(APP_PROF_STATE_ENCODE, start);
+	if (len < 0) {
+		LOG_ERR("Failed to encode state: %d", len);
+		return len;
+	}
+
 	err = golioth_lightdb_set_async(client,
-					APP_STATE_ACTUAL_ENDP,
-					GOLIOTH_CONTENT_TYPE_JSON,
-					sbuf,
-					strlen(sbuf),
-					async_handler,
+					path,
+					STATE_CONTENT_TYPE,
+					buf,
+					len,
+					cb,
 					NULL);
-
 	if (err) {
 		LOG_ERR("Unable to write to LightDB State: %d", err);
 	}
 	return err;
 }
 
-static void app_state_desired_handler(struct golioth_client *client, enum golioth_status status,
-				      const struct golioth_coap_rsp_code *coap_rsp_code,
-				      const char *path, const uint8_t *payload, size_t payload_size,
-				      void *arg)
+static void actual_set_handler(struct golioth_client *client,
+			       enum golioth_status status,
+			       const struct golioth_coap_rsp_code *coap_rsp_code,
+			       const char *path,
+			       void *arg)
 {
-	int err = 0;
-	int ret;
+	uint32_t version;
+	bool converged;
+
+	k_mutex_lock(&state_lock, K_FOREVER);
+	actual_in_flight = false;
+	if (status == GOLIOTH_OK) {
+		acked = sent;
+		acked_valid = true;
+	}
+	version = sent_version;
+	converged = acked_valid && (sent_version == actual_version);
+	k_mutex_unlock(&state_lock);
 
 	if (status != GOLIOTH_OK) {
-		LOG_ERR("Failed to receive '%s' endpoint: %d", APP_STATE_DESIRED_ENDP, status);
+		LOG_WRN("Failed to set state: %d", status);
+		k_work_schedule(&flush_work, K_SECONDS(STATE_RETRY_S));
 		return;
 	}
 
-	LOG_HEXDUMP_DBG(payload, payload_size, APP_STATE_DESIRED_ENDP);
+	LOG_DBG("State version %u acknowledged", version);
 
-	struct app_state parsed_state;
+	if (!converged) {
+		/* The state changed while the write was in flight */
+		k_work_schedule(&flush_work, K_NO_WAIT);
+	}
+}
+
+static void desired_reset_handler(struct golioth_client *client,
+				  enum golioth_status status,
+				  const struct golioth_coap_rsp_code *coap_rsp_code,
+				  const char *path,
+				  void *arg)
+{
+	bool pending;
 
-	ret = json_obj_parse((char *)payload, payload_size, app_state_descr,
-			     ARRAY_SIZE(app_state_descr), &parsed_state);
+	k_mutex_lock(&state_lock, K_FOREVER);
+	desired_reset_in_flight = false;
+	if (status != GOLIOTH_OK) {
+		desired_reset_pending = true;
+	}
+	pending = desired_reset_pending;
+	k_mutex_unlock(&state_lock);
 
-	if (ret < 0) {
-		LOG_ERR("Error parsing desired values: %d", ret);
-		app_state_reset_desired();
+	if (status != GOLIOTH_OK) {
+		LOG_WRN("Failed to reset desired state: %d", status);
+		k_work_schedule(&flush_work, K_SECONDS(STATE_RETRY_S));
 		return;
 	}
 
-	uint8_t desired_processed_count = 0;
-	uint8_t state_change_count = 0;
+	LOG_DBG("Desired state reset");
 
-	if (ret & 1 << 0) {
-		/* Process example_int0 */
-		if ((parsed_state.example_int0 >= 0) && (parsed_state.example_int0 < 65536)) {
-			LOG_DBG("Validated desired example_int0 value: %d",
-				parsed_state.example_int0);
-			if (_example_int0 != parsed_state.example_int0) {
-				_example_int0 = parsed_state.example_int0;
-				++state_change_count;
-			}
-			++desired_processed_count;
-		} else if (parsed_state.example_int0 == -1) {
-			LOG_DBG("No change requested for example_int0");
+	if (pending) {
+		/* More desired values arrived while the reset was in flight */
+		k_work_schedule(&flush_work, K_NO_WAIT);
+	}
+}
+
+static void flush_work_handler(struct k_work *work)
+{
+	struct state_values snapshot;
+	struct state_values no_change;
+	bool write_actual = false;
+	bool reset_desired = false;
+	uint32_t version;
+	int err;
+
+	k_mutex_lock(&state_lock, K_FOREVER);
+
+	/* A write in flight reschedules the flush when it completes */
+	if (!actual_in_flight) {
+		if (acked_valid && (memcmp(&actual, &acked, sizeof(actual)) == 0)) {
+			/* Changes that cancel out within a burst are never sent */
+			sent_version = actual_version;
 		} else {
-			LOG_ERR("Invalid desired example_int0 value: %d",
-				parsed_state.example_int0);
-			++desired_processed_count;
-		}
-	}
-	if (ret & 1 << 1) {
-		/* Process example_int1 */
-		if ((parsed_state.example_int1 >= 0) && (parsed_state.example_int1 < 65536)) {
-			LOG_DBG("Validated desired example_int1 value: %d",
-				parsed_state.example_int1);
-			if (_example_int1 != parsed_state.example_int1) {
-				_example_int1 = parsed_state.example_int1;
-				++state_change_count;
+			sent = actual;
+			sent_version = actual_version;
+			actual_in_flight = true;
+			write_actual = true;
+		}
+	}
+	snapshot = sent;
+	version = sent_version;
+
+	if (desired_reset_pending && !desired_reset_in_flight) {
+		desired_reset_pending = false;
+		desired_reset_in_flight = true;
+		reset_desired = true;
+	}
+
+	k_mutex_unlock(&state_lock);
+
+	if (write_actual) {
+		LOG_DBG("Writing state version %u", version);
+
+		err = state_write(APP_STATE_ACTUAL_ENDP, &snapshot, actual_set_handler);
+		if (err) {
+			k_mutex_lock(&state_lock, K_FOREVER);
+			actual_in_flight = false;
+			k_mutex_unlock(&state_lock);
+			k_work_schedule(&flush_work, K_SECONDS(STATE_RETRY_S));
+		}
+	}
+
+	if (reset_desired) {
+		LOG_INF("Resetting \"%s\" LightDB State endpoint to defaults.",
+			APP_STATE_DESIRED_ENDP);
+
+		for (int i = 0; i < STATE_FIELD_COUNT; i++) {
+			no_change.val[i] = STATE_NO_CHANGE;
+		}
+
+		err = state_write(APP_STATE_DESIRED_ENDP, &no_change, desired_reset_handler);
+		if (err) {
+			k_mutex_lock(&state_lock, K_FOREVER);
+			desired_reset_in_flight = false;
+			desired_reset_pending = true;
+			k_mutex_unlock(&state_lock);
+			k_work_schedule(&flush_work, K_SECONDS(STATE_RETRY_S));
+		}
+	}
+}
+
+/*
+ * Apply the desired values to the shadow. Call with state_lock held.
+ *
+ * @param changed Set to the fields whose value changed
+ * @return true if a value was processed and must be reset on the server
+ */
+static bool desired_apply(const struct state_desired *desired, uint32_t *changed)
+{
+	bool processed = false;
+
+	*changed = 0;
+
+	for (int i = 0; i < STATE_FIELD_COUNT; i++) {
+		const struct state_field *field = &state_fields[i];
+		int32_t value = desired->val[i];
+
+		if (!(desired->present & BIT(i))) {
+			continue;
+		}
+
+		if (!(desired->invalid & BIT(i)) && (value >= field->min) &&
+		    (value <= field->max)) {
+			LOG_DBG("Validated desired %s value: %d", field->name, value);
+			if (actual.val[i] != value) {
+				actual.val[i] = value;
+				actual_version++;
+				*changed |= BIT(i);
 			}
-			++desired_processed_count;
-		} else if (parsed_state.example_int1 == -1) {
-			LOG_DBG("No change requested for example_int1");
+			processed = true;
+		} else if (!(desired->invalid & BIT(i)) && (value == STATE_NO_CHANGE)) {
+			LOG_DBG("No change requested for %s", field->name);
 		} else {
-			LOG_ERR("Invalid desired example_int1 value: %d",
-				parsed_state.example_int1);
-			++desired_processed_count;
+			LOG_ERR("Invalid desired %s value", field->name);
+			processed = true;
 		}
 	}
 
-	if (state_change_count) {
-		/* The state was changed, so update the state on the Golioth servers */
-		err = app_state_update_actual();
-	}
+	return processed;
+}
 
-	if (desired_processed_count) {
-		/* We processed some desired changes to return these to -1 on the server
-		 * to indicate the desired values were received.
-		 */
-		err = app_state_reset_desired();
+static void app_state_desired_handler(struct golioth_client *client, enum golioth_status status,
+				      const struct golioth_coap_rsp_code *coap_rsp_code,
+				      const char *path, const uint8_t *payload, size_t payload_size,
+				      void *arg)
+{
+	struct state_desired desired = {0};
+	struct state_values applied;
+	uint32_t changed = 0;
+	uint32_t start;
+	bool processed;
+	int err;
+
+	if (status != GOLIOTH_OK) {
+		LOG_ERR("Failed to receive '%s' endpoint: %d", APP_STATE_DESIRED_ENDP, status);
+		return;
 	}
 
+	LOG_HEXDUMP_DBG(payload, payload_size, APP_STATE_DESIRED_ENDP);
+
+	start = app_prof_start();
+	err = state_parse(payload, payload_size, &desired);
+	app_prof_record(APP_PROF_STATE_PARSE, start);
+	IF_ENABLED(CONFIG_APP_STATE_PARSE_COMPARE, (state_parse_compare(payload, payload_size);));
+
+	k_mutex_lock(&state_lock, K_FOREVER);
+
 	if (err) {
-		LOG_ERR("Failed to update cloud state: %d", err);
+		LOG_ERR("Error parsing desired values: %d", err);
+		processed = true;
+	} else {
+		processed = desired_apply(&desired, &changed);
 	}
+
+	if (processed) {
+		desired_reset_pending = true;
+	}
+
+	applied = actual;
+
+	k_mutex_unlock(&state_lock);
+
+	for (int i = 0; i < STATE_FIELD_COUNT; i++) {
+		if ((changed & BIT(i)) && state_fields[i].apply) {
+			state_fields[i].apply(applied.val[i]);
+		}
+	}
+
+	if (processed) {
+		/* Desired updates often come in bursts; write the result once */
+		k_work_reschedule(&flush_work, K_MSEC(CONFIG_APP_STATE_FLUSH_MS));
+	}
+}
+
+void app_state_sync(void)
+{
+	k_work_schedule(&flush_work, K_NO_WAIT);
 }
 
 int app_state_observe(struct golioth_client *state_client)
@@ -174,7 +678,7 @@ int app_state_observe(struct golioth_client *state_client)
 
 	err = golioth_lightdb_observe_async(client,
 					    APP_STATE_DESIRED_ENDP,
-					    GOLIOTH_CONTENT_TYPE_JSON,
+					    STATE_CONTENT_TYPE,
 					    app_state_desired_handler,
 					    NULL);
 	if (err) {
@@ -186,7 +690,7 @@ int app_state_observe(struct golioth_client *state_client)
 	 * with the Golioth servers. Future updates will be sent whenever
 	 * changes occur.
 	 */
-	err = app_state_update_actual();
+	app_state_sync();
 
-	return err;
+	return 0;
 }
@@ -17,6 +17,15 @@
  * processed, and update the actual state (`APP_STATE_ACTUAL_ENDP`) to report
  * the new state of the device.
  *
+ * State fields are declared in one table in app_state.c, which drives parsing,
+ * validation and encoding of both endpoints. Payloads are CBOR, or JSON with
+ * `CONFIG_APP_STATE_ENCODING_JSON`, and are parsed in place without copying.
+ *
+ * Both endpoints are written from a local shadow. Desired values received
+ * within `CONFIG_APP_STATE_FLUSH_MS` of each other are answered with at most
+ * one actual state write and one desired reset, and the actual state is not
+ * written when it matches what the server last acknowledged.
+ *
  * The device should write to the _actual state_ endpoint, the cloud should not.
  * By convention the cloud should consider the _actual state_ values read-only.
  *
@@ -32,6 +41,8 @@
 #define APP_STATE_ACTUAL_ENDP  "state"
 
 int app_state_observe(struct golioth_client *state_client);
-int app_state_update_actual(void);
+
+/** Write any state not yet acknowledged by the server; call when (re)connected */
+void app_state_sync(void);
 
 #endif /* __APP_STATE_H__ */
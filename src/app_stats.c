@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_stats, LOG_LEVEL_DBG);
+
+#include <golioth/client.h>
+#include <golioth/stream.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#ifdef CONFIG_APP_STREAM_ENCODING_CBOR
+#include <zcbor_encode.h>
+#endif
+
+#include "app_fixed.h"
+#include "app_json.h"
+#include "app_settings.h"
+#include "app_stats.h"
+#include "app_stream.h"
+#include "app_time.h"
+
+/* Worst case length of the summary of one channel */
+#define STATS_CHANNEL_JSON_MAX_LEN 160
+#define STATS_CHANNEL_CBOR_MAX_LEN 64
+
+/* Nesting depth of a summary: document map -> group map -> channel map */
+#define CBOR_STATS_DEPTH 3
+
+#ifdef CONFIG_APP_STREAM_ENCODING_CBOR
+#define STATS_MAX_LEN (APP_CH_COUNT * STATS_CHANNEL_CBOR_MAX_LEN + 64)
+#define STATS_CONTENT_TYPE GOLIOTH_CONTENT_TYPE_CBOR
+#else
+#define STATS_MAX_LEN (APP_CH_COUNT * STATS_CHANNEL_JSON_MAX_LEN + 64)
+#define STATS_CONTENT_TYPE GOLIOTH_CONTENT_TYPE_JSON
+#endif
+
+static struct golioth_client *client;
+
+/* Current window; only used from the main loop */
+static struct stats_acc window[APP_CH_COUNT];
+static int64_t window_start_ms;
+static uint32_t window_samples;
+static bool window_open;
+
+static uint8_t stats_buf[STATS_MAX_LEN];
+
+void stats_acc_reset(struct stats_acc *acc)
+{
+	acc->count = 0;
+	acc->min = INT32_MAX;
+	acc->max = INT32_MIN;
+	acc->mean = 0;
+	acc->m2 = 0;
+}
+
+void stats_acc_add(struct stats_acc *acc, int32_t value)
+{
+	int64_t x = (int64_t)value << STATS_FRAC_BITS;
+	int64_t delta;
+
+	acc->count++;
+	acc->min = MIN(acc->min, value);
+	acc->max = MAX(acc->max, value);
+
+	/*
+	 * Welford: both deltas have the same sign, so their product is never
+	 * negative. It fits in 64 bits as long as |delta| < 2^(23 + FRAC_BITS).
+	 */
+	delta = x - acc->mean;
+	acc->mean += delta / (int64_t)acc->count;
+	acc->m2 += (uint64_t)(delta * (x - acc->mean));
+}
+
+uint64_t stats_acc_variance(const struct stats_acc *acc)
+{
+	if (acc->count < 2) {
+		return 0;
+	}
+
+	return acc->m2 / (acc->count - 1);
+}
+
+/* Divisor from accumulator units to the units of the streamed value */
+static uint64_t value_den(const struct app_channel_info *info)
+{
+	return info->milli ? MILLI_PER_UNIT : 1;
+}
+
+static uint64_t mean_den(const struct app_channel_info *info)
+{
+	return value_den(info) << STATS_FRAC_BITS;
+}
+
+static uint64_t variance_den(const struct app_channel_info *info)
+{
+	return (value_den(info) * value_den(info)) << (2 * STATS_FRAC_BITS);
+}
+
+#ifdef CONFIG_APP_STREAM_ENCODING_CBOR
+
+static int encode_stats(uint8_t *buf, size_t len, int32_t window_s, int64_t ts_ms)
+{
+	ZCBOR_STATE_E(zse, CBOR_STATS_DEPTH, buf, len, 1);
+	const char *group = NULL;
+	bool ok;
+
+	ok = zcbor_map_start_encode(zse, APP_CH_COUNT) &&
+	     zcbor_tstr_put_lit(zse, "window_s") && zcbor_int32_put(zse, window_s);
+
+	if (ts_ms) {
+		ok = ok && zcbor_tstr_put_lit(zse, "ts") && zcbor_int64_put(zse, ts_ms);
+	}
+
+	for (int i = 0; ok && (i < APP_CH_COUNT); i++) {
+		const struct app_channel_info *info = &app_channels[i];
+		const struct stats_acc *acc = &window[i];
+
+		if (!info->stats || (acc->count == 0)) {
+			continue;
+		}
+
+		if (info->group != group) {
+			/* Close the previous group (if any) and open the next one */
+			if (group) {
+				ok = zcbor_map_end_encode(zse, APP_CH_COUNT);
+			}
+			ok = ok && zcbor_tstr_encode_ptr(zse, info->group, strlen(info->group)) &&
+			     zcbor_map_start_encode(zse, APP_CH_COUNT);
+			group = info->group;
+		}
+
+		ok = ok && zcbor_tstr_encode_ptr(zse, info->key, strlen(info->key)) &&
+		     zcbor_map_start_encode(zse, 5) &&
+		     zcbor_tstr_put_lit(zse, "n") && zcbor_uint32_put(zse, acc->count) &&
+		     zcbor_tstr_put_lit(zse, "min") &&
+		     fixed_float32_put(zse, acc->min, value_den(info)) &&
+		     zcbor_tstr_put_lit(zse, "max") &&
+		     fixed_float32_put(zse, acc->max, value_den(info)) &&
+		     zcbor_tstr_put_lit(zse, "mean") &&
+		     fixed_float32_put(zse, acc->mean, mean_den(info)) &&
+		     zcbor_tstr_put_lit(zse, "var") &&
+		     fixed_float32_put(zse, stats_acc_variance(acc), variance_den(info)) &&
+		     zcbor_map_end_encode(zse, 5);
+	}
+
+	if (group) {
+		ok = ok && zcbor_map_end_encode(zse, APP_CH_COUNT);
+	}
+
+	ok = ok && zcbor_map_end_encode(zse, APP_CH_COUNT);
+	if (!ok) {
+		return -ENOMEM;
+	}
+
+	return zse->payload - buf;
+}
+
+#else
+
+/* `num / den` in milli-units; fits as long as num * 1000 does */
+static int64_t to_milli(int64_t num, uint64_t den)
+{
+	return (num * MILLI_PER_UNIT) / (int64_t)den;
+}
+
+static int encode_stats(uint8_t *out, size_t len, int32_t window_s, int64_t ts_ms)
+{
+	char *buf = (char *)out;
+	const char *group = NULL;
+	size_t pos = 0;
+	int err;
+
+	err = app_json_append(buf, len, &pos, "{\"window_s\":%d", window_s);
+
+	if (!err && ts_ms) {
+		err = app_json_append(buf, len, &pos, ",\"ts\":%lld", ts_ms);
+	}
+
+	for (int i = 0; !err && (i < APP_CH_COUNT); i++) {
+		const struct app_channel_info *info = &app_channels[i];
+		const struct stats_acc *acc = &window[i];
+		int64_t min, max, mean, var;
+
+		if (!info->stats || (acc->count == 0)) {
+			continue;
+		}
+
+		if (info->group != group) {
+			/* Close the previous group (if any) and open the next one */
+			err = app_json_append(buf, len, &pos, "%s,\"%s\":{", group ? "}" : "",
+					      info->group);
+			group = info->group;
+		} else {
+			err = app_json_append(buf, len, &pos, ",");
+		}
+		if (err) {
+			return err;
+		}
+
+		min = to_milli(acc->min, value_den(info));
+		max = to_milli(acc->max, value_den(info));
+		mean = to_milli(acc->mean, mean_den(info));
+		var = to_milli(stats_acc_variance(acc), variance_den(info));
+
+		err = app_json_append(buf, len, &pos,
+				      "\"%s\":{\"n\":%u,\"min\":" PRIMILLI ",\"max\":" PRIMILLI
+				      ",\"mean\":" PRIMILLI ",\"var\":" PRIMILLI "}",
+				      info->key, acc->count, MILLI_ARGS(min), MILLI_ARGS(max),
+				      MILLI_ARGS(mean), MILLI_ARGS(var));
+	}
+
+	if (!err) {
+		err = app_json_append(buf, len, &pos, group ? "}}" : "}");
+	}
+	if (err) {
+		return err;
+	}
+
+	return pos;
+}
+
+#endif /* CONFIG_APP_STREAM_ENCODING_CBOR */
+
+static void upload_window(int32_t window_s)
+{
+	int64_t ts_ms = 0;
+	int err;
+	int len;
+
+	if (!golioth_client_is_connected(client)) {
+		LOG_WRN("Not connected, dropping statistics window");
+		return;
+	}
+
+	/* The summary is stamped with the start of its window */
+	app_time_to_unix_ms(window_start_ms, &ts_ms);
+
+	len = encode_stats(stats_buf, sizeof(stats_buf), window_s, ts_ms);
+	if (len < 0) {
+		LOG_ERR("Failed to encode statistics: %d", len);
+		return;
+	}
+
+	err = golioth_stream_set_async(client,
+				       "stats",
+				       STATS_CONTENT_TYPE,
+				       stats_buf,
+				       len,
+				       app_stream_sent_handler,
+				       NULL);
+	if (err) {
+		LOG_ERR("Failed to send statistics to Golioth: %d", err);
+		return;
+	}
+
+	LOG_DBG("Sent statistics of %u samples (%d bytes)", window_samples, len);
+}
+
+void app_stats_set_client(struct golioth_client *stats_client)
+{
+	client = stats_client;
+}
+
+void app_stats_reset(void)
+{
+	window_open = false;
+}
+
+void app_stats_add(const struct app_sample *sample)
+{
+	int32_t window_s = get_stats_window_s();
+
+	/* A window covers [start, start + STATS_WINDOW_S) */
+	if (window_open &&
+	    (sample->uptime_ms - window_start_ms >= (int64_t)window_s * MSEC_PER_SEC)) {
+		upload_window(window_s);
+		app_stats_reset();
+	}
+
+	if (!window_open) {
+		for (int i = 0; i < APP_CH_COUNT; i++) {
+			stats_acc_reset(&window[i]);
+		}
+
+		window_start_ms = sample->uptime_ms;
+		window_samples = 0;
+		window_open = true;
+	}
+
+	window_samples++;
+
+	for (int i = 0; i < APP_CH_COUNT; i++) {
+		if (!app_channels[i].stats || !(sample->mask & BIT(i))) {
+			continue;
+		}
+
+		stats_acc_add(&window[i], sample->val[i]);
+	}
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Windowed statistics of the sensor channels.
+ *
+ * When the `STATS_WINDOW_S` setting is non-zero, sensors are sampled every
+ * `STATS_SAMPLE_S` seconds and each sample is folded into a running summary
+ * instead of being streamed. When the window is over, one document holding
+ * the count, min, max, mean and variance of every channel is uploaded to the
+ * `stats` path of LightDB Stream, and a new window starts.
+ *
+ * The summary is computed incrementally with Welford's algorithm in fixed
+ * point, so no sample has to be kept and the result does not suffer from the
+ * cancellation of the naive sum of squares method.
+ */
+
+#ifndef __APP_STATS_H__
+#define __APP_STATS_H__
+
+#include <stdint.h>
+#include <golioth/client.h>
+#include "app_sensors.h"
+
+/* Fractional bits of the running mean; the variance has twice as many */
+#define STATS_FRAC_BITS 8
+
+/**
+ * Running summary of one channel.
+ *
+ * Inputs are in the units used by the deadbands (milli-units for fractional
+ * channels, counts otherwise) and must differ from the mean by less than 2^23.
+ */
+struct stats_acc {
+	uint32_t count;
+	int32_t min;
+	int32_t max;
+	/* Mean in Q(STATS_FRAC_BITS) */
+	int64_t mean;
+	/* Sum of squared differences from the mean in Q(2 * STATS_FRAC_BITS) */
+	uint64_t m2;
+};
+
+void stats_acc_reset(struct stats_acc *acc);
+void stats_acc_add(struct stats_acc *acc, int32_t value);
+
+/** Sample variance in Q(2 * STATS_FRAC_BITS); 0 until two values were added */
+uint64_t stats_acc_variance(const struct stats_acc *acc);
+
+void app_stats_set_client(struct golioth_client *stats_client);
+
+/** Add a sample to the current window, uploading the summary once the window is over */
+void app_stats_add(const struct app_sample *sample);
+
+/** Discard the current window */
+void app_stats_reset(void);
+
+#endif /* __APP_STATS_H__ */
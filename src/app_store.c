@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_store, LOG_LEVEL_DBG);
+
+#include <stddef.h>
+#include <zephyr/fs/fcb.h>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+
+#include "app_store.h"
+
+#define STORE_PARTITION_ID FIXED_PARTITION_ID(sample_storage)
+#define STORE_MAGIC	   0x534d504c /* "SMPL" */
+
+/*
+ * Layout of the stored struct app_sample. Bump whenever its fields change;
+ * the checks below break the build when they do. Entries of another size,
+ * from a build with other channels, are skipped when read.
+ */
+#define STORE_VERSION	   5
+#define STORE_VAL_OFFSET   20
+
+BUILD_ASSERT(offsetof(struct app_sample, val) == STORE_VAL_OFFSET,
+	     "struct app_sample changed: bump STORE_VERSION and update STORE_VAL_OFFSET");
+BUILD_ASSERT(sizeof(struct app_sample) ==
+		     ROUND_UP(STORE_VAL_OFFSET + sizeof(int32_t) * APP_CH_COUNT,
+			      __alignof__(struct app_sample)),
+	     "struct app_sample changed: bump STORE_VERSION");
+
+static struct flash_sector store_sectors[CONFIG_APP_STORE_SECTORS_MAX];
+static struct fcb store_fcb;
+static bool store_ready;
+
+/* Next entry to upload, and the entry following the last peeked one */
+static struct fcb_entry read_loc;
+static struct fcb_entry peek_loc;
+
+static int store_count_cb(struct fcb_entry_ctx *entry_ctx, void *arg)
+{
+	(*(size_t *)arg)++;
+	return 0;
+}
+
+static int store_fcb_init(void)
+{
+	uint32_t sector_cnt = ARRAY_SIZE(store_sectors);
+	int err;
+
+	err = flash_area_get_sectors(STORE_PARTITION_ID, &sector_cnt, store_sectors);
+	if (err) {
+		LOG_ERR("Unable to get sample storage sectors: %d", err);
+		return err;
+	}
+
+	store_fcb.f_magic = STORE_MAGIC;
+	store_fcb.f_version = STORE_VERSION;
+	store_fcb.f_sectors = store_sectors;
+	store_fcb.f_sector_cnt = sector_cnt;
+	store_fcb.f_scratch_cnt = 0;
+
+	return fcb_init(STORE_PARTITION_ID, &store_fcb);
+}
+
+int app_store_init(void)
+{
+	const struct flash_area *fa;
+	size_t count = 0;
+	int err;
+
+	err = store_fcb_init();
+	if (err) {
+		/* Written by an incompatible firmware or never formatted */
+		LOG_WRN("Erasing sample storage (%d)", err);
+
+		err = flash_area_open(STORE_PARTITION_ID, &fa);
+		if (err) {
+			LOG_ERR("Unable to open sample storage: %d", err);
+			return err;
+		}
+
+		err = flash_area_erase(fa, 0, fa->fa_size);
+		flash_area_close(fa);
+		if (err) {
+			LOG_ERR("Unable to erase sample storage: %d", err);
+			return err;
+		}
+
+		err = store_fcb_init();
+		if (err) {
+			LOG_ERR("Unable to initialize sample storage: %d", err);
+			return err;
+		}
+	}
+
+	fcb_walk(&store_fcb, NULL, store_count_cb, &count);
+	LOG_INF("Sample storage: %u sectors, %zu samples pending", store_fcb.f_sector_cnt, count);
+
+	memset(&read_loc, 0, sizeof(read_loc));
+	store_ready = true;
+
+	return 0;
+}
+
+int app_store_append(const struct app_sample *sample)
+{
+	struct fcb_entry loc;
+	int err;
+
+	if (!store_ready) {
+		return -ENODEV;
+	}
+
+	err = fcb_append(&store_fcb, sizeof(*sample), &loc);
+	if (err == -ENOSPC) {
+		LOG_WRN("Sample storage full, dropping oldest sector");
+
+		if (read_loc.fe_sector == store_fcb.f_oldest) {
+			memset(&read_loc, 0, sizeof(read_loc));
+		}
+		/* Peeked samples may be waiting for their upload to be acknowledged */
+		if (peek_loc.fe_sector == store_fcb.f_oldest) {
+			memset(&peek_loc, 0, sizeof(peek_loc));
+		}
+
+		err = fcb_rotate(&store_fcb);
+		if (err) {
+			return err;
+		}
+
+		err = fcb_append(&store_fcb, sizeof(*sample), &loc);
+	}
+	if (err) {
+		return err;
+	}
+
+	err = flash_area_write(store_fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc), sample, sizeof(*sample));
+	if (err) {
+		return err;
+	}
+
+	return fcb_append_finish(&store_fcb, &loc);
+}
+
+bool app_store_is_empty(void)
+{
+	struct fcb_entry loc = read_loc;
+
+	return !store_ready || (fcb_getnext(&store_fcb, &loc) != 0);
+}
+
+int app_store_peek(struct app_sample *samples, size_t max)
+{
+	struct fcb_entry loc = read_loc;
+	struct fcb_entry next;
+	size_t count = 0;
+	int err;
+
+	if (!store_ready) {
+		return -ENODEV;
+	}
+
+	while (count < max) {
+		next = loc;
+		if (fcb_getnext(&store_fcb, &next) != 0) {
+			break;
+		}
+		loc = next;
+
+		if (loc.fe_data_len != sizeof(*samples)) {
+			LOG_WRN("Skipping stored entry of %u bytes", loc.fe_data_len);
+			continue;
+		}
+
+		err = flash_area_read(store_fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc), &samples[count],
+				      sizeof(*samples));
+		if (err) {
+			return err;
+		}
+
+		count++;
+	}
+
+	peek_loc = loc;
+
+	return count;
+}
+
+void app_store_consume(void)
+{
+	struct fcb_entry loc;
+
+	read_loc = peek_loc;
+	loc = read_loc;
+
+	if (fcb_getnext(&store_fcb, &loc) != 0) {
+		/* Everything has been uploaded */
+		fcb_clear(&store_fcb);
+		memset(&read_loc, 0, sizeof(read_loc));
+		return;
+	}
+
+	/* Erase sectors whose samples have all been uploaded */
+	while (store_fcb.f_oldest != read_loc.fe_sector) {
+		if (fcb_rotate(&store_fcb)) {
+			break;
+		}
+	}
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Persistent store-and-forward queue for sensor samples.
+ *
+ * While the Golioth client is disconnected, samples are appended to a flash
+ * circular buffer (FCB) in the `sample_storage` partition instead of being
+ * dropped. Once the client reconnects they are read back oldest first and
+ * uploaded in large batches (see app_stream.h).
+ *
+ * The FCB writes sectors in turn and erases the oldest sector when the
+ * partition is full, so wear is spread evenly and the queue size is bounded
+ * by the partition size. Samples are consumed once the server acknowledged
+ * their upload, and their sectors are erased when every sample in them has
+ * been consumed. A batch that is not acknowledged is peeked and sent again.
+ * The read position is kept in RAM, so samples uploaded just before a reboot
+ * may be sent a second time.
+ *
+ * These functions are not thread safe. They are called from the stream flush
+ * work item only.
+ */
+
+#ifndef __APP_STORE_H__
+#define __APP_STORE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "app_sensors.h"
+
+int app_store_init(void);
+int app_store_append(const struct app_sample *sample);
+bool app_store_is_empty(void);
+
+/**
+ * Read the oldest samples not yet consumed.
+ *
+ * @return number of samples copied to `samples`, or a negative error code
+ */
+int app_store_peek(struct app_sample *samples, size_t max);
+
+/**
+ * Remove the samples returned by the last call to app_store_peek(). Call once
+ * the server acknowledged their upload.
+ */
+void app_store_consume(void);
+
+#endif /* __APP_STORE_H__ */
@@ -0,0 +1,696 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_stream, LOG_LEVEL_DBG);
+
+#include <golioth/client.h>
+#include <golioth/stream.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zcbor_encode.h>
+
+#include "app_boot.h"
+#include "app_fixed.h"
+#include "app_json.h"
+#include "app_prof.h"
+#include "app_settings.h"
+#include "app_store.h"
+#include "app_stream.h"
+#include "app_time.h"
+
+/*
+ * Worst case length of one encoded sample with every channel of the registry.
+ * Each channel is counted as if it opened its own group, which keeps the bound
+ * simple. sizeof() of a key or group is its length plus one: the CBOR text
+ * string header, or the NUL written by vsnprintk() for JSON.
+ *
+ * CBOR: key, float32 or int32 value (5 bytes), group with its map header and
+ * break; the sample map header and break, and "ts" with an int64 (12 bytes).
+ */
+#define CH_CBOR_MAX_LEN(_group, _key) (sizeof(_group) + 2 + sizeof(_key) + 5)
+#define CH_CBOR_X(_id, _chan, _group, _key, ...) +CH_CBOR_MAX_LEN(_group, _key)
+#define CH_CBOR_D(_id, _group, _key, ...) +CH_CBOR_MAX_LEN(_group, _key)
+#define SAMPLE_CBOR_MAX_LEN (2 + 12 APP_CHANNELS(CH_CBOR_X, CH_CBOR_D))
+
+/*
+ * JSON: `"group":{` and `},`, `"key":` with a value of up to 12 characters
+ * (PRIMILLI of INT32_MIN) and `,`; `{"ts":` with 20 digits, `,` and `}`.
+ */
+#define CH_JSON_MAX_LEN(_group, _key) (sizeof(_group) + 5 + sizeof(_key) + 15)
+#define CH_JSON_X(_id, _chan, _group, _key, ...) +CH_JSON_MAX_LEN(_group, _key)
+#define CH_JSON_D(_id, _group, _key, ...) +CH_JSON_MAX_LEN(_group, _key)
+#define SAMPLE_JSON_MAX_LEN (28 APP_CHANNELS(CH_JSON_X, CH_JSON_D))
+
+/* The CBOR bound assumes names short enough for a one byte text string header */
+#define CH_NAME_CHECK(_group, _key)                                                                \
+	BUILD_ASSERT((sizeof(_group) <= 24) && (sizeof(_key) <= 24),                               \
+		     "Channel " _group "/" _key " is too long for SAMPLE_CBOR_MAX_LEN");
+#define CH_NAME_CHECK_X(_id, _chan, _group, _key, ...) CH_NAME_CHECK(_group, _key)
+#define CH_NAME_CHECK_D(_id, _group, _key, ...) CH_NAME_CHECK(_group, _key)
+APP_CHANNELS(CH_NAME_CHECK_X, CH_NAME_CHECK_D)
+
+/* Nesting depth of a batch: array -> sample map -> group map */
+#define CBOR_BATCH_DEPTH 3
+
+/* Array header and break; brackets and the NUL of vsnprintk() */
+#define CBOR_BATCH_OVERHEAD 4
+#define JSON_BATCH_OVERHEAD 3
+
+/*
+ * A batch is uploaded in a single CoAP request, not blockwise, so it must fit
+ * in one block. Samples that do not fit are left for the next batch.
+ */
+#define PAYLOAD_MAX_LEN CONFIG_GOLIOTH_BLOCKWISE_UPLOAD_MAX_BLOCK_SIZE
+
+#define JSON_BATCH_MAX_LEN                                                                         \
+	(CONFIG_APP_STREAM_BATCH_MAX * SAMPLE_JSON_MAX_LEN + JSON_BATCH_OVERHEAD)
+
+static struct golioth_client *client;
+
+/* Ring buffer of samples waiting to be uploaded */
+static struct app_sample samples[CONFIG_APP_STREAM_BUFFER_LEN];
+static size_t sample_head; /* index of the oldest sample */
+static size_t sample_count;
+static K_MUTEX_DEFINE(sample_lock);
+
+#ifdef CONFIG_APP_STREAM_ENCODING_CBOR
+#define SAMPLE_MAX_LEN	     SAMPLE_CBOR_MAX_LEN
+#define BATCH_OVERHEAD	     CBOR_BATCH_OVERHEAD
+#define PAYLOAD_CONTENT_TYPE GOLIOTH_CONTENT_TYPE_CBOR
+#else
+#define SAMPLE_MAX_LEN	     SAMPLE_JSON_MAX_LEN
+#define BATCH_OVERHEAD	     JSON_BATCH_OVERHEAD
+#define PAYLOAD_CONTENT_TYPE GOLIOTH_CONTENT_TYPE_JSON
+#endif
+
+BUILD_ASSERT(BATCH_OVERHEAD + SAMPLE_MAX_LEN <= PAYLOAD_MAX_LEN,
+	     "A sample with every channel does not fit in one stream upload");
+
+/* Encoded batch and its samples; only used from the flush work item */
+static uint8_t payload_buf[PAYLOAD_MAX_LEN];
+
+/* One sample encoded on its own, to find how many fit in payload_buf */
+static uint8_t sample_buf[SAMPLE_MAX_LEN];
+
+#ifdef CONFIG_APP_STREAM_ENCODING_COMPARE
+static uint8_t compare_buf[JSON_BATCH_MAX_LEN];
+#endif
+
+/* Samples of the batch being encoded */
+static struct app_sample batch_buf[CONFIG_APP_STREAM_BATCH_MAX];
+
+#ifdef CONFIG_APP_STORE
+/* Upload of the samples last peeked from the store */
+enum store_upload_state {
+	STORE_UPLOAD_IDLE,
+	STORE_UPLOAD_SENT,
+	STORE_UPLOAD_ACKED,
+	STORE_UPLOAD_FAILED,
+};
+
+static atomic_t store_upload = ATOMIC_INIT(STORE_UPLOAD_IDLE);
+#endif
+
+/* Report-by-exception state; only used from app_stream_push() */
+static int32_t last_reported[APP_CH_COUNT];
+/* Channels are read at different periods, so each one keeps its own heartbeat */
+static int64_t last_heartbeat_ms[APP_CH_COUNT];
+static uint32_t reported_once;
+static atomic_t suppressed_count = ATOMIC_INIT(0);
+
+static void flush_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(flush_work, flush_work_handler);
+
+void app_stream_sent_handler(struct golioth_client *client, enum golioth_status status,
+			     const struct golioth_coap_rsp_code *coap_rsp_code, const char *path,
+			     void *arg)
+{
+	if (status != GOLIOTH_OK) {
+		LOG_ERR("Async task failed: %d", status);
+		return;
+	}
+
+	app_boot_mark(APP_BOOT_FIRST_UPLOAD);
+}
+
+#if defined(CONFIG_APP_STREAM_ENCODING_JSON) || defined(CONFIG_APP_STREAM_ENCODING_COMPARE)
+
+static int encode_sample_json(const struct app_sample *sample, char *buf, size_t len,
+			      size_t *pos)
+{
+	const char *group = NULL;
+	const char *sep = "";
+	int err;
+
+	err = app_json_append(buf, len, pos, "{");
+	if (err) {
+		return err;
+	}
+
+	if (sample->ts_ms) {
+		err = app_json_append(buf, len, pos, "\"ts\":%lld", sample->ts_ms);
+		if (err) {
+			return err;
+		}
+		sep = ",";
+	}
+
+	for (int i = 0; i < APP_CH_COUNT; i++) {
+		const struct app_channel_info *info = &app_channels[i];
+		int32_t val = sample->val[i];
+
+		if (!(sample->mask & BIT(i))) {
+			continue;
+		}
+
+		if (info->group != group) {
+			/* Close the previous group (if any) and open the next one */
+			err = app_json_append(buf, len, pos, "%s\"%s\":{", group ? "}," : sep,
+					      info->group);
+			if (err) {
+				return err;
+			}
+			group = info->group;
+		} else {
+			err = app_json_append(buf, len, pos, ",");
+			if (err) {
+				return err;
+			}
+		}
+
+		if (info->milli) {
+			err = app_json_append(buf, len, pos, "\"%s\":" PRIMILLI, info->key,
+					      MILLI_ARGS(val));
+		} else {
+			err = app_json_append(buf, len, pos, "\"%s\":%d", info->key, val);
+		}
+		if (err) {
+			return err;
+		}
+	}
+
+	return app_json_append(buf, len, pos, group ? "}}" : "}");
+}
+
+/* Encode `count` samples as a JSON array */
+static int encode_batch_json(const struct app_sample *batch, size_t count, char *buf, size_t len)
+{
+	size_t pos = 0;
+	int err;
+
+	err = app_json_append(buf, len, &pos, "[");
+	if (err) {
+		return err;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (i) {
+			err = app_json_append(buf, len, &pos, ",");
+			if (err) {
+				return err;
+			}
+		}
+
+		err = encode_sample_json(&batch[i], buf, len, &pos);
+		if (err) {
+			return err;
+		}
+	}
+
+	err = app_json_append(buf, len, &pos, "]");
+	if (err) {
+		return err;
+	}
+
+	return pos;
+}
+
+#endif /* CONFIG_APP_STREAM_ENCODING_JSON || CONFIG_APP_STREAM_ENCODING_COMPARE */
+
+#ifdef CONFIG_APP_STREAM_ENCODING_CBOR
+
+static bool encode_sample_cbor(zcbor_state_t *zse, const struct app_sample *sample)
+{
+	const char *group = NULL;
+	bool ok;
+
+	ok = zcbor_map_start_encode(zse, APP_CH_COUNT);
+
+	if (sample->ts_ms) {
+		ok = ok && zcbor_tstr_put_lit(zse, "ts") && zcbor_int64_put(zse, sample->ts_ms);
+	}
+
+	for (int i = 0; ok && (i < APP_CH_COUNT); i++) {
+		const struct app_channel_info *info = &app_channels[i];
+		int32_t val = sample->val[i];
+
+		if (!(sample->mask & BIT(i))) {
+			continue;
+		}
+
+		if (info->group != group) {
+			/* Close the previous group (if any) and open the next one */
+			if (group) {
+				ok = zcbor_map_end_encode(zse, APP_CH_COUNT);
+			}
+			ok = ok && zcbor_tstr_encode_ptr(zse, info->group, strlen(info->group)) &&
+			     zcbor_map_start_encode(zse, APP_CH_COUNT);
+			group = info->group;
+		}
+
+		ok = ok && zcbor_tstr_encode_ptr(zse, info->key, strlen(info->key));
+
+		if (info->milli) {
+			ok = ok && fixed_float32_put(zse, val, MILLI_PER_UNIT);
+		} else {
+			ok = ok && zcbor_int32_put(zse, val);
+		}
+	}
+
+	if (group) {
+		ok = ok && zcbor_map_end_encode(zse, APP_CH_COUNT);
+	}
+
+	return ok && zcbor_map_end_encode(zse, APP_CH_COUNT);
+}
+
+/* Encode `count` samples as a CBOR array */
+static int encode_batch_cbor(const struct app_sample *batch, size_t count, uint8_t *buf,
+			     size_t len)
+{
+	ZCBOR_STATE_E(zse, CBOR_BATCH_DEPTH, buf, len, 1);
+	bool ok;
+
+	ok = zcbor_list_start_encode(zse, CONFIG_APP_STREAM_BATCH_MAX);
+
+	for (size_t i = 0; ok && (i < count); i++) {
+		ok = encode_sample_cbor(zse, &batch[i]);
+	}
+
+	ok = ok && zcbor_list_end_encode(zse, CONFIG_APP_STREAM_BATCH_MAX);
+	if (!ok) {
+		return -ENOMEM;
+	}
+
+	return zse->payload - buf;
+}
+
+#endif /* CONFIG_APP_STREAM_ENCODING_CBOR */
+
+/* Encoded length of one sample, or a negative error code */
+static int sample_len(const struct app_sample *sample)
+{
+#ifdef CONFIG_APP_STREAM_ENCODING_CBOR
+	ZCBOR_STATE_E(zse, CBOR_BATCH_DEPTH - 1, sample_buf, sizeof(sample_buf), 1);
+
+	if (!encode_sample_cbor(zse, sample)) {
+		return -ENOMEM;
+	}
+
+	return zse->payload - sample_buf;
+#else
+	size_t pos = 0;
+	int err;
+
+	err = encode_sample_json(sample, (char *)sample_buf, sizeof(sample_buf), &pos);
+
+	return err ? err : pos;
+#endif
+}
+
+/* Number of samples from the start of `batch` whose encoding fits in payload_buf */
+static size_t batch_fit(const struct app_sample *batch, size_t count)
+{
+	size_t len = BATCH_OVERHEAD;
+	size_t n;
+
+	for (n = 0; n < count; n++) {
+		int next = sample_len(&batch[n]);
+
+		if (next < 0) {
+			break;
+		}
+
+		/* A JSON sample after the first is preceded by a comma */
+		if (IS_ENABLED(CONFIG_APP_STREAM_ENCODING_JSON) && n) {
+			next++;
+		}
+
+		if (len + next > sizeof(payload_buf)) {
+			break;
+		}
+		len += next;
+	}
+
+	return n;
+}
+
+/*
+ * Encode as many of the `*count` samples of `batch` as fit in payload_buf and
+ * set `*count` to their number.
+ *
+ * @return encoded length, or -EMSGSIZE when not even the first sample fits
+ */
+static int encode_batch(const struct app_sample *batch, size_t *count)
+{
+	uint32_t start = k_cycle_get_32();
+	int len;
+
+	*count = batch_fit(batch, *count);
+	if (*count == 0) {
+		return -EMSGSIZE;
+	}
+
+#ifdef CONFIG_APP_STREAM_ENCODING_CBOR
+	len = encode_batch_cbor(batch, *count, payload_buf, sizeof(payload_buf));
+#else
+	len = encode_batch_json(batch, *count, (char *)payload_buf, sizeof(payload_buf));
+#endif
+
+	LOG_DBG("Encoded %zu samples: %d bytes in %u us", *count, len,
+		k_cyc_to_us_floor32(k_cycle_get_32() - start));
+	app_prof_record(APP_PROF_ENCODE, start);
+
+#ifdef CONFIG_APP_STREAM_ENCODING_COMPARE
+	int json_len;
+
+	start = k_cycle_get_32();
+	json_len = encode_batch_json(batch, *count, (char *)compare_buf, sizeof(compare_buf));
+
+	LOG_INF("JSON comparison: %d bytes in %u us", json_len,
+		k_cyc_to_us_floor32(k_cycle_get_32() - start));
+#endif
+
+	return len;
+}
+
+/*
+ * Upload the samples of `batch` that fit in one request and set `*count` to
+ * their number. -EMSGSIZE means that the first sample cannot be sent at all.
+ * `cb` is called with the response of the server.
+ */
+static int send_batch(const struct app_sample *batch, size_t *count, golioth_set_cb_fn cb)
+{
+	int err;
+	int len;
+
+	len = encode_batch(batch, count);
+	if (len < 0) {
+		LOG_ERR("Failed to encode sensor batch: %d", len);
+		return len;
+	}
+
+	err = golioth_stream_set_async(client,
+				       "sensor",
+				       PAYLOAD_CONTENT_TYPE,
+				       payload_buf,
+				       len,
+				       cb,
+				       NULL);
+	if (err) {
+		LOG_ERR("Failed to send sensor data to Golioth: %d", err);
+		return err;
+	}
+
+	LOG_DBG("Sent batch of %zu samples (%d bytes)", *count, len);
+
+	return 0;
+}
+
+#ifdef CONFIG_APP_STORE
+
+/* Move every buffered sample to flash. Call with sample_lock held. */
+static void spill_to_store(void)
+{
+	int err;
+
+	while (sample_count) {
+		err = app_store_append(&samples[sample_head]);
+		if (err) {
+			LOG_ERR("Failed to store sample: %d", err);
+			return;
+		}
+
+		sample_head = (sample_head + 1) % ARRAY_SIZE(samples);
+		sample_count--;
+	}
+
+	LOG_DBG("Not connected, samples moved to flash");
+}
+
+/* Callback for the upload of stored samples */
+static void store_sent_handler(struct golioth_client *client, enum golioth_status status,
+			       const struct golioth_coap_rsp_code *coap_rsp_code, const char *path,
+			       void *arg)
+{
+	if (status != GOLIOTH_OK) {
+		LOG_ERR("Stored samples not acknowledged: %d", status);
+		atomic_set(&store_upload, STORE_UPLOAD_FAILED);
+		k_work_reschedule(&flush_work, K_SECONDS(get_stream_max_age_s()));
+		return;
+	}
+
+	app_boot_mark(APP_BOOT_FIRST_UPLOAD);
+
+	/* Consume the batch and send the next one from the flush work item */
+	atomic_set(&store_upload, STORE_UPLOAD_ACKED);
+	k_work_reschedule(&flush_work, K_NO_WAIT);
+}
+
+/*
+ * Upload samples stored while offline, one batch per request. A batch is only
+ * removed from flash once the server acknowledged it, and samples in RAM wait
+ * for the store to be empty so that they are uploaded in order.
+ *
+ * @return 0 once the store is empty, -EINPROGRESS while a batch is in flight
+ */
+static int drain_store(void)
+{
+	size_t count;
+	int ret;
+	int err;
+
+	switch (atomic_get(&store_upload)) {
+	case STORE_UPLOAD_SENT:
+		return -EINPROGRESS;
+	case STORE_UPLOAD_ACKED:
+		app_store_consume();
+		break;
+	default:
+		/* Failed batches are peeked and sent again */
+		break;
+	}
+
+	atomic_set(&store_upload, STORE_UPLOAD_IDLE);
+
+	if (app_store_is_empty()) {
+		return 0;
+	}
+
+	ret = app_store_peek(batch_buf, get_stream_batch_size());
+	if (ret <= 0) {
+		/* Only entries of another layout were left; skip them */
+		if (ret == 0) {
+			app_store_consume();
+		}
+		return ret;
+	}
+
+	/* The callback may run before golioth_stream_set_async() returns */
+	atomic_set(&store_upload, STORE_UPLOAD_SENT);
+
+	count = ret;
+	err = send_batch(batch_buf, &count, store_sent_handler);
+	if (err == -EMSGSIZE) {
+		LOG_ERR("Dropping stored sample");
+		(void)app_store_peek(batch_buf, 1);
+		app_store_consume();
+		atomic_set(&store_upload, STORE_UPLOAD_IDLE);
+		k_work_reschedule(&flush_work, K_NO_WAIT);
+		return err;
+	} else if (err) {
+		atomic_set(&store_upload, STORE_UPLOAD_IDLE);
+		return err;
+	}
+
+	if (count < ret) {
+		/* Peek again so that only the samples sent are consumed */
+		(void)app_store_peek(batch_buf, count);
+	}
+
+	return -EINPROGRESS;
+}
+
+#endif /* CONFIG_APP_STORE */
+
+/*
+ * Convert capture times to Unix time while the uptime they refer to is still
+ * the current boot's. Call with sample_lock held.
+ */
+static void timestamp_samples(void)
+{
+	for (size_t i = 0; i < sample_count; i++) {
+		struct app_sample *sample = &samples[(sample_head + i) % ARRAY_SIZE(samples)];
+
+		if (sample->ts_ms == 0) {
+			app_time_to_unix_ms(sample->uptime_ms, &sample->ts_ms);
+		}
+	}
+}
+
+static void flush_work_handler(struct k_work *work)
+{
+	int err;
+
+	k_mutex_lock(&sample_lock, K_FOREVER);
+
+	timestamp_samples();
+
+	/* Only stream sensor data if connected */
+	if (!golioth_client_is_connected(client)) {
+		COND_CODE_1(CONFIG_APP_STORE,
+			    (spill_to_store();),
+			    (LOG_DBG("Not connected, holding %zu samples", sample_count);));
+		goto reschedule;
+	}
+
+	/* Stored samples are older than the ones in RAM, send them first */
+	IF_ENABLED(CONFIG_APP_STORE, (
+		err = drain_store();
+		if (err) {
+			goto reschedule;
+		}
+	));
+
+	while (sample_count) {
+		size_t count = MIN(sample_count, (size_t)get_stream_batch_size());
+
+		for (size_t i = 0; i < count; i++) {
+			batch_buf[i] = samples[(sample_head + i) % ARRAY_SIZE(samples)];
+		}
+
+		err = send_batch(batch_buf, &count, app_stream_sent_handler);
+		if (err == -EMSGSIZE) {
+			LOG_ERR("Dropping sample");
+			count = 1;
+		} else if (err) {
+			break;
+		}
+
+		sample_head = (sample_head + count) % ARRAY_SIZE(samples);
+		sample_count -= count;
+	}
+
+reschedule:
+	if (sample_count) {
+		/* Try again once the oldest sample has aged out again */
+		k_work_schedule(&flush_work, K_SECONDS(get_stream_max_age_s()));
+	}
+
+	k_mutex_unlock(&sample_lock);
+}
+
+/*
+ * Narrow the sample mask to the channels worth reporting: those that moved by
+ * more than their deadband since they were last reported, or whose heartbeat
+ * is due. Sets *urgent when an urgent channel changed.
+ */
+static uint32_t report_by_exception(const struct app_sample *sample, bool *urgent)
+{
+	int64_t heartbeat_ms = (int64_t)get_stream_heartbeat_s() * MSEC_PER_SEC;
+	uint32_t heartbeat = 0;
+	uint32_t mask = 0;
+
+	for (int i = 0; i < APP_CH_COUNT; i++) {
+		const struct app_channel_info *info = &app_channels[i];
+		int64_t delta;
+
+		if (!(sample->mask & BIT(i))) {
+			continue;
+		}
+
+		if (!(reported_once & BIT(i)) ||
+		    (sample->uptime_ms - last_heartbeat_ms[i] >= heartbeat_ms)) {
+			heartbeat |= BIT(i);
+			last_heartbeat_ms[i] = sample->uptime_ms;
+		}
+
+		delta = (int64_t)sample->val[i] - last_reported[i];
+
+		if (info->urgent) {
+			if (delta != 0) {
+				*urgent = true;
+				mask |= BIT(i);
+			}
+		} else if ((delta > get_deadband(info->deadband)) ||
+			   (-delta > get_deadband(info->deadband))) {
+			mask |= BIT(i);
+		}
+	}
+
+	if (heartbeat) {
+		mask |= heartbeat;
+		reported_once |= heartbeat;
+
+		LOG_INF("Heartbeat: %ld uploads suppressed since boot",
+			atomic_get(&suppressed_count));
+	}
+
+	for (int i = 0; i < APP_CH_COUNT; i++) {
+		if (mask & BIT(i)) {
+			last_reported[i] = sample->val[i];
+		}
+	}
+
+	return mask;
+}
+
+void app_stream_push(const struct app_sample *sample)
+{
+	bool urgent = false;
+	uint32_t mask;
+
+	mask = report_by_exception(sample, &urgent);
+	if (!mask) {
+		LOG_DBG("No channel changed, %ld uploads suppressed",
+			atomic_inc(&suppressed_count) + 1);
+		return;
+	}
+
+	k_mutex_lock(&sample_lock, K_FOREVER);
+
+	if (sample_count == ARRAY_SIZE(samples)) {
+		LOG_WRN("Sample buffer full, dropping oldest sample");
+		sample_head = (sample_head + 1) % ARRAY_SIZE(samples);
+		sample_count--;
+	}
+
+	struct app_sample *slot = &samples[(sample_head + sample_count) % ARRAY_SIZE(samples)];
+
+	*slot = *sample;
+	slot->mask = mask;
+	sample_count++;
+
+	if (urgent || (sample_count >= (size_t)get_stream_batch_size())) {
+		k_work_reschedule(&flush_work, K_NO_WAIT);
+	} else if (sample_count == 1) {
+		/* First sample of a new batch starts the max age timer */
+		k_work_schedule(&flush_work, K_SECONDS(get_stream_max_age_s()));
+	}
+
+	k_mutex_unlock(&sample_lock);
+}
+
+void app_stream_flush(void)
+{
+	k_work_reschedule(&flush_work, K_NO_WAIT);
+}
+
+void app_stream_set_client(struct golioth_client *stream_client)
+{
+	client = stream_client;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __APP_STREAM_H__
+#define __APP_STREAM_H__
+
+/**
+ * Buffer sensor samples in RAM and upload them to LightDB Stream in batches.
+ *
+ * Each call to `app_stream_push()` appends one sample to a fixed-size ring
+ * buffer. The buffered samples are sent as a single array payload once
+ * `STREAM_BATCH_SIZE` samples are waiting, or when the oldest sample is older
+ * than `STREAM_MAX_AGE_S` (see app_settings.h). Grouping samples this way
+ * amortizes the per-message CoAP/DTLS overhead and keeps the radio off for
+ * longer.
+ *
+ * Before a sample is buffered, channels that did not move by more than their
+ * deadband since they were last reported are dropped from it (report by
+ * exception). A sample with no remaining channel is not uploaded at all. Every
+ * channel is reported at least once per `STREAM_HEARTBEAT_S`, and a change of
+ * the moisture level is uploaded immediately.
+ *
+ * https://docs.golioth.io/firmware/golioth-firmware-sdk/stream-client
+ */
+
+#include <golioth/client.h>
+#include "app_sensors.h"
+
+void app_stream_set_client(struct golioth_client *stream_client);
+void app_stream_push(const struct app_sample *sample);
+void app_stream_flush(void);
+
+/**
+ * Callback for `golioth_stream_set_async()` uploads that need no other
+ * handling: logs a failure, or marks the first successful upload since boot.
+ */
+void app_stream_sent_handler(struct golioth_client *client, enum golioth_status status,
+			     const struct golioth_coap_rsp_code *coap_rsp_code, const char *path,
+			     void *arg);
+
+#endif /* __APP_STREAM_H__ */
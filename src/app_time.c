@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_time, LOG_LEVEL_DBG);
+
+#include <date_time.h>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+#include "app_time.h"
+
+#define PARTS_PER_BILLION 1000000000LL
+
+/*
+ * Updates closer together than this say little about the drift: network time
+ * has a resolution of one second.
+ */
+#define DRIFT_MIN_INTERVAL_MS (30 * 60 * MSEC_PER_SEC)
+
+/* Crystal drift is far below this; larger estimates come from bad updates */
+#define DRIFT_MAX_PPB 500000
+
+static struct k_spinlock time_lock;
+static bool time_valid;
+static int64_t base_uptime_ms;
+static int64_t base_unix_ms;
+/* How much faster network time runs than the uptime clock, in parts per billion */
+static int32_t drift_ppb;
+
+static int64_t to_unix_ms(int64_t uptime_ms)
+{
+	int64_t elapsed_ms = uptime_ms - base_uptime_ms;
+
+	return base_unix_ms + elapsed_ms + (elapsed_ms * drift_ppb) / PARTS_PER_BILLION;
+}
+
+static const char *source_name(enum date_time_evt_type type)
+{
+	switch (type) {
+	case DATE_TIME_OBTAINED_MODEM:
+		return "modem";
+	case DATE_TIME_OBTAINED_NTP:
+		return "NTP";
+	default:
+		return "external";
+	}
+}
+
+static void date_time_handler(const struct date_time_evt *evt)
+{
+	k_spinlock_key_t key;
+	int64_t uptime_ms;
+	int64_t unix_ms;
+	int64_t error_ms = 0;
+	int64_t interval_ms = 0;
+	int err;
+
+	if (evt->type == DATE_TIME_NOT_OBTAINED) {
+		LOG_WRN("Network time not available");
+		return;
+	}
+
+	uptime_ms = k_uptime_get();
+	err = date_time_now(&unix_ms);
+	if (err) {
+		LOG_ERR("Failed to read network time: %d", err);
+		return;
+	}
+
+	key = k_spin_lock(&time_lock);
+
+	if (time_valid) {
+		interval_ms = uptime_ms - base_uptime_ms;
+		error_ms = unix_ms - to_unix_ms(uptime_ms);
+
+		/* Correct half of the residual drift, to average out update jitter */
+		if (interval_ms >= DRIFT_MIN_INTERVAL_MS) {
+			drift_ppb += (error_ms * PARTS_PER_BILLION) / interval_ms / 2;
+			drift_ppb = CLAMP(drift_ppb, -DRIFT_MAX_PPB, DRIFT_MAX_PPB);
+		}
+	}
+
+	base_uptime_ms = uptime_ms;
+	base_unix_ms = unix_ms;
+	time_valid = true;
+
+	k_spin_unlock(&time_lock, key);
+
+	LOG_INF("Time base from %s: error %lld ms after %lld s, drift %d ppb",
+		source_name(evt->type), error_ms, interval_ms / MSEC_PER_SEC, drift_ppb);
+}
+
+int app_time_to_unix_ms(int64_t uptime_ms, int64_t *unix_ms)
+{
+	k_spinlock_key_t key = k_spin_lock(&time_lock);
+	int err = 0;
+
+	if (time_valid) {
+		*unix_ms = to_unix_ms(uptime_ms);
+	} else {
+		err = -EAGAIN;
+	}
+
+	k_spin_unlock(&time_lock, key);
+
+	return err;
+}
+
+void app_time_init(void)
+{
+	date_time_register_handler(date_time_handler);
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Wall-clock time base for sample timestamps.
+ *
+ * Samples are stamped with `k_uptime_get()` when they are captured and only
+ * converted to Unix time before they are uploaded or moved to flash, so a
+ * sample that waited in a batch keeps the time it was measured at. The time
+ * base is taken from the network by the NCS date_time library (LTE network
+ * time, or NTP) whenever it obtains a new time, which it does again every
+ * `CONFIG_DATE_TIME_UPDATE_INTERVAL_SECONDS`.
+ *
+ * On every update after the first, the difference between the network time
+ * and the time predicted from the previous update is used to refine an
+ * estimate of the uptime clock drift, which corrects conversions in between
+ * updates.
+ */
+
+#ifndef __APP_TIME_H__
+#define __APP_TIME_H__
+
+#include <errno.h>
+#include <stdint.h>
+
+#ifdef CONFIG_APP_TIME
+
+void app_time_init(void);
+
+/**
+ * Convert an uptime of the current boot to Unix time.
+ *
+ * @return 0, or -EAGAIN if no time base was obtained yet
+ */
+int app_time_to_unix_ms(int64_t uptime_ms, int64_t *unix_ms);
+
+#else
+
+static inline int app_time_to_unix_ms(int64_t uptime_ms, int64_t *unix_ms)
+{
+	return -ENOTSUP;
+}
+
+#endif /* CONFIG_APP_TIME */
+
+#endif /* __APP_TIME_H__ */
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+#include <zephyr/sys/util.h>
+
+#include "app_moisture.h"
+#include "app_vwc.h"
+
+#define RAW_Q(_raw) ((int32_t)(_raw) << VWC_RAW_FRAC_BITS)
+
+static void skip_spaces(const char **p, const char *end)
+{
+	while ((*p < end) && ((**p == ' ') || (**p == '\t'))) {
+		(*p)++;
+	}
+}
+
+/*
+ * Parse a non-negative decimal number with up to `decimals` fractional digits,
+ * scaled by 10^decimals, no larger than `max`.
+ */
+static int parse_fixed(const char **p, const char *end, int decimals, int32_t max, int32_t *out)
+{
+	int64_t value = 0;
+	int digits = 0;
+	int frac = -1;
+
+	skip_spaces(p, end);
+
+	for (; *p < end; (*p)++) {
+		char c = **p;
+
+		if ((c == '.') && (frac < 0) && (decimals > 0)) {
+			frac = 0;
+			continue;
+		}
+
+		if ((c < '0') || (c > '9')) {
+			break;
+		}
+
+		if ((frac >= decimals) || (value > max)) {
+			return -EINVAL;
+		}
+
+		value = (value * 10) + (c - '0');
+		digits++;
+		if (frac >= 0) {
+			frac++;
+		}
+	}
+
+	if ((digits == 0) || (frac == 0)) {
+		return -EINVAL;
+	}
+
+	for (frac = MAX(frac, 0); frac < decimals; frac++) {
+		value *= 10;
+	}
+
+	if (value > max) {
+		return -EINVAL;
+	}
+
+	skip_spaces(p, end);
+	*out = (int32_t)value;
+
+	return 0;
+}
+
+static void sort_points(struct vwc_point *points, size_t count)
+{
+	/* Insertion sort; curves are short and usually entered in order */
+	for (size_t i = 1; i < count; i++) {
+		struct vwc_point v = points[i];
+		size_t j = i;
+
+		while ((j > 0) && (points[j - 1].raw > v.raw)) {
+			points[j] = points[j - 1];
+			j--;
+		}
+		points[j] = v;
+	}
+}
+
+int vwc_curve_check(const struct vwc_curve *curve)
+{
+	if ((curve->count == 1) || (curve->count > CONFIG_APP_VWC_POINTS_MAX)) {
+		return -EINVAL;
+	}
+
+	for (uint32_t i = 0; i < curve->count; i++) {
+		const struct vwc_point *point = &curve->points[i];
+
+		if ((point->raw < 0) || (point->raw > MOISTURE_ADC_MAX) || (point->vwc < 0) ||
+		    (point->vwc > VWC_MAX)) {
+			return -EINVAL;
+		}
+
+		if ((i > 0) && (point->raw <= curve->points[i - 1].raw)) {
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+int vwc_curve_parse(struct vwc_curve *curve, const char *str, size_t len)
+{
+	const char *end = str + len;
+	const char *p = str;
+	struct vwc_curve parsed;
+	int err;
+
+	/* Unused points are zeroed so equal curves compare equal */
+	memset(&parsed, 0, sizeof(parsed));
+
+	skip_spaces(&p, end);
+
+	while (p < end) {
+		struct vwc_point *point;
+
+		if (parsed.count == CONFIG_APP_VWC_POINTS_MAX) {
+			return -E2BIG;
+		}
+
+		point = &parsed.points[parsed.count++];
+
+		err = parse_fixed(&p, end, 0, MOISTURE_ADC_MAX, &point->raw);
+		if (err || (p == end) || (*p++ != ':')) {
+			return -EINVAL;
+		}
+
+		err = parse_fixed(&p, end, 3, VWC_MAX, &point->vwc);
+		if (err) {
+			return err;
+		}
+
+		if (p < end) {
+			/* A separator must be followed by another point */
+			if ((*p++ != ',') || (p == end)) {
+				return -EINVAL;
+			}
+		}
+	}
+
+	sort_points(parsed.points, parsed.count);
+
+	/* Duplicate readings show up as neighbours once sorted */
+	err = vwc_curve_check(&parsed);
+	if (err) {
+		return err;
+	}
+
+	memcpy(curve, &parsed, sizeof(parsed));
+
+	return 0;
+}
+
+int32_t vwc_temp_compensate(uint16_t raw, int32_t temp, int32_t coeff, int32_t ref_c)
+{
+	/* milli-counts/°C * m°C = micro-counts */
+	int64_t drift = (int64_t)coeff * ((int64_t)temp - ((int64_t)ref_c * 1000));
+	int64_t raw_q = RAW_Q(raw) - ((drift * (1 << VWC_RAW_FRAC_BITS)) / 1000000);
+
+	return (int32_t)CLAMP(raw_q, 0, RAW_Q(MOISTURE_ADC_MAX));
+}
+
+int32_t vwc_eval(const struct vwc_curve *curve, int32_t raw_q)
+{
+	const struct vwc_point *points = curve->points;
+	uint32_t lo = 0;
+	uint32_t hi = curve->count - 1;
+	int64_t num;
+	int64_t den;
+
+	if (raw_q <= RAW_Q(points[lo].raw)) {
+		return points[lo].vwc;
+	}
+
+	if (raw_q >= RAW_Q(points[hi].raw)) {
+		return points[hi].vwc;
+	}
+
+	/* Find the segment with points[lo].raw <= raw < points[hi].raw */
+	while ((hi - lo) > 1) {
+		uint32_t mid = lo + ((hi - lo) / 2);
+
+		if (RAW_Q(points[mid].raw) <= raw_q) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+
+	num = (int64_t)(points[hi].vwc - points[lo].vwc) * (raw_q - RAW_Q(points[lo].raw));
+	den = RAW_Q(points[hi].raw - points[lo].raw);
+
+	/* Round to nearest; VWC falls with the reading on most curves */
+	num += (num < 0) ? -(den / 2) : (den / 2);
+
+	return points[lo].vwc + (int32_t)(num / den);
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Calibration of the moisture probe to volumetric water content (VWC).
+ *
+ * A calibration curve is a list of (raw counts, VWC) points measured for one
+ * probe in its soil. A filtered reading is converted by finding the segment
+ * around it with a binary search and interpolating linearly between its two
+ * ends; readings outside the curve take the VWC of the nearest end. VWC is
+ * carried in milli-percent, like every other fractional reading.
+ *
+ * The probe output drifts with temperature. With a non-zero coefficient, the
+ * reading is first moved back to the reference temperature of the curve using
+ * the last BME280 temperature, unless it is older than the weather period.
+ *
+ * Curves are held in fixed-size arrays and evaluated with integer arithmetic
+ * only: converting a reading takes at most log2(CONFIG_APP_VWC_POINTS_MAX)
+ * comparisons and one 64-bit division, and never allocates.
+ */
+
+#ifndef __APP_VWC_H__
+#define __APP_VWC_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Fractional bits of a temperature compensated reading */
+#define VWC_RAW_FRAC_BITS 8
+
+/* 100 %, in milli-percent */
+#define VWC_MAX 100000
+
+/* Both fields are 32-bit so a curve has no padding and can be compared with memcmp() */
+struct vwc_point {
+	/* Filtered ADC reading */
+	int32_t raw;
+	/* Water content at that reading, in milli-percent */
+	int32_t vwc;
+};
+
+struct vwc_curve {
+	/* Sorted by ascending raw reading, without duplicates */
+	struct vwc_point points[CONFIG_APP_VWC_POINTS_MAX];
+	/* 0 when the probe is not calibrated */
+	uint32_t count;
+};
+
+/**
+ * Parse a curve from text such as `"3400:0, 2900:12.5, 2300:41"`: points
+ * separated by commas, each a raw reading and a VWC in percent with up to
+ * three decimals. Points may be given in any order.
+ *
+ * An empty string yields an empty curve. `curve` is only written on success.
+ *
+ * @return 0, or -EINVAL if the text is malformed, a value is out of range,
+ *         two points share a raw reading or there is a single point, or
+ *         -E2BIG if there are more than CONFIG_APP_VWC_POINTS_MAX points
+ */
+int vwc_curve_parse(struct vwc_curve *curve, const char *str, size_t len);
+
+/** Check a curve restored from storage; 0 if it could have been parsed */
+int vwc_curve_check(const struct vwc_curve *curve);
+
+/**
+ * Move a reading to the reference temperature.
+ *
+ * @param raw Filtered ADC reading
+ * @param temp Temperature of the probe, in m°C
+ * @param coeff Change of the reading per °C, in milli-counts
+ * @param ref_c Temperature the curve was measured at, in °C
+ *
+ * @return Compensated reading in Q(VWC_RAW_FRAC_BITS)
+ */
+int32_t vwc_temp_compensate(uint16_t raw, int32_t temp, int32_t coeff, int32_t ref_c);
+
+/**
+ * VWC of a reading, in milli-percent.
+ *
+ * @param curve Curve with at least two points
+ * @param raw_q Reading in Q(VWC_RAW_FRAC_BITS)
+ */
+int32_t vwc_eval(const struct vwc_curve *curve, int32_t raw_q);
+
+#endif /* __APP_VWC_H__ */
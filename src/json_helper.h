@@ -9,6 +9,7 @@
 
 #include <zephyr/data/json.h>
 
+/* Reference parser for CONFIG_APP_STATE_PARSE_COMPARE; see app_state.c */
 struct app_state {
 	int32_t example_int0;
 	int32_t example_int1;
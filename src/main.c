@@ -8,10 +8,19 @@
 LOG_MODULE_REGISTER(golioth_soil_moisture, LOG_LEVEL_DBG);
 
 #include <app_version.h>
+#include "app_boot.h"
+#include "app_burst.h"
 #include "app_rpc.h"
+#include "app_sched.h"
 #include "app_settings.h"
 #include "app_state.h"
+#include "app_display.h"
+#include "app_history.h"
+#include "app_log.h"
 #include "app_sensors.h"
+#include "app_store.h"
+#include "app_stream.h"
+#include "app_time.h"
 #include <golioth/client.h>
 #include <golioth/fw_update.h>
 #include <samples/common/net_connect.h>
@@ -23,7 +32,6 @@ LOG_MODULE_REGISTER(golioth_soil_moisture, LOG_LEVEL_DBG);
 #endif
 #ifdef CONFIG_LIB_OSTENTUS
 #include <libostentus.h>
-#include <libostentus_regmap.h>
 static const struct device *o_dev = DEVICE_DT_GET_ANY(golioth_ostentus);
 #endif
 #ifdef CONFIG_ALUDEL_BATTERY_MONITOR
@@ -41,9 +49,9 @@ static const char *_current_version =
 	STRINGIFY(APP_VERSION_MAJOR) "." STRINGIFY(APP_VERSION_MINOR) "." STRINGIFY(APP_PATCHLEVEL);
 
 static struct golioth_client *client;
-K_SEM_DEFINE(connected, 0, 1);
 
-static k_tid_t _system_thread = 0;
+/* Given to re-evaluate the sensor schedule before its next slot */
+static K_SEM_DEFINE(wake, 0, 1);
 
 #if DT_NODE_EXISTS(DT_ALIAS(golioth_led))
 static const struct gpio_dt_spec golioth_led = GPIO_DT_SPEC_GET(DT_ALIAS(golioth_led), gpios);
@@ -56,7 +64,7 @@ void golioth_connection_led_set(uint8_t state);
 
 void wake_system_thread(void)
 {
-	k_wakeup(_system_thread);
+	k_sem_give(&wake);
 }
 
 static void on_client_event(struct golioth_client *client, enum golioth_client_event event,
@@ -65,8 +73,12 @@ static void on_client_event(struct golioth_client *client, enum golioth_client_e
 	bool is_connected = (event == GOLIOTH_CLIENT_EVENT_CONNECTED);
 
 	if (is_connected) {
-		k_sem_give(&connected);
+		app_boot_mark(APP_BOOT_CONNECTED);
 		golioth_connection_led_set(1);
+
+		/* Upload anything that was buffered while offline */
+		app_stream_flush();
+		app_state_sync();
 	}
 	LOG_INF("Golioth client %s", is_connected ? "connected" : "disconnected");
 }
@@ -98,6 +110,9 @@ static void start_golioth_client(void)
 
 	/* Register RPC service */
 	app_rpc_register(client);
+
+	/* Ship logs in batches */
+	app_log_set_client(client);
 }
 
 #ifdef CONFIG_SOC_SERIES_NRF91X
@@ -109,6 +124,8 @@ static void lte_handler(const struct lte_lc_evt *const evt)
 		if ((evt->nw_reg_status == LTE_LC_NW_REG_REGISTERED_HOME) ||
 		    (evt->nw_reg_status == LTE_LC_NW_REG_REGISTERED_ROAMING)) {
 
+			app_boot_mark(APP_BOOT_NETWORK);
+
 			/* Change the state of the Internet LED on Ostentus */
 			IF_ENABLED(CONFIG_LIB_OSTENTUS, (ostentus_led_internet_set(o_dev, 1);));
 
@@ -120,6 +137,25 @@ static void lte_handler(const struct lte_lc_evt *const evt)
 	}
 }
 
+#else
+
+static K_THREAD_STACK_DEFINE(net_stack, CONFIG_APP_NET_STACK_SIZE);
+static struct k_thread net_thread;
+
+/* Bring up the network and the Golioth client without holding up sampling */
+static void net_thread_entry(void *p1, void *p2, void *p3)
+{
+	/* Run WiFi/DHCP if necessary */
+	if (IS_ENABLED(CONFIG_GOLIOTH_SAMPLE_COMMON)) {
+		net_connect();
+	}
+
+	app_boot_mark(APP_BOOT_NETWORK);
+
+	/* Start Golioth client */
+	start_golioth_client();
+}
+
 #endif /* CONFIG_SOC_SERIES_NRF91X */
 
 #ifdef CONFIG_MODEM_INFO
@@ -146,7 +182,12 @@ void button_pressed(const struct device *dev, struct gpio_callback *cb, uint32_t
 	/* This function is an Interrupt Service Routine. Do not call functions that
 	 * use other threads, or perform long-running operations here
 	 */
-	k_wakeup(_system_thread);
+#ifdef CONFIG_APP_BURST_BUTTON
+	if (app_burst_start(CONFIG_APP_BURST_DURATION_S) == 0) {
+		return;
+	}
+#endif
+	app_sched_request(APP_TASK_ALL);
 }
 
 /* Set (unset) LED indicators for active Golioth connection */
@@ -167,36 +208,38 @@ int main(void)
 {
 	int err;
 
+	app_boot_mark(APP_BOOT_MAIN);
+
 	LOG_INF("Start Golioth Soil Moisture Monitor sample");
 
 	LOG_INF("Firmware version: %s", _current_version);
 	IF_ENABLED(CONFIG_MODEM_INFO, (log_modem_firmware_version();));
 
 	IF_ENABLED(CONFIG_LIB_OSTENTUS, (
-		/* Reset Ostentus and pause for reboot */
-		ostentus_reset(o_dev);
-		k_msleep(300);
-
-		/* Read firmware version from faceplate */
-		char *o_version = (char *)calloc(32, sizeof(char));
-
-		ostentus_version_get(o_dev, o_version, 32);
-		LOG_INF("Ostentus reports firmware version: %s", o_version);
-		free(o_version);
+		/* The faceplate is reset and set up on the display work queue */
+		app_display_init();
 
-		/* Update Ostentus LEDS using bitmask (Power On and Battery) */
-		ostentus_led_bitmask(o_dev, LED_POW | LED_BAT);
-
-		/* Show Golioth Logo on Ostentus ePaper screen */
-		ostentus_show_splash(o_dev);
+		/* Update the Firmware slide with the firmware version */
+		app_display_slide_set(FIRMWARE, _current_version);
 	));
 
-	/* Get system thread id so loop delay change event can wake main */
-	_system_thread = k_current_get();
+	/* Start with the settings last received from Golioth */
+	IF_ENABLED(CONFIG_APP_SETTINGS_PERSIST, (app_settings_load();));
 
 	/*Initialize sensors using sensor subsystem*/
 	sensor_init();
 
+	/* Open the offline sample store before the first sample is taken */
+	IF_ENABLED(CONFIG_APP_STORE, (app_store_init();));
+
+	/* Restore the hourly history saved by the previous boots */
+	IF_ENABLED(CONFIG_APP_HISTORY, (app_history_init();));
+
+	/* Follow network time updates for sample timestamps */
+	IF_ENABLED(CONFIG_APP_TIME, (app_time_init();));
+
+	app_boot_mark(APP_BOOT_SENSORS);
+
 #if DT_NODE_EXISTS(DT_ALIAS(golioth_led))
 	/* Initialize Golioth logo LED */
 	err = gpio_pin_configure_dt(&golioth_led, GPIO_OUTPUT_INACTIVE);
@@ -205,6 +248,7 @@ int main(void)
 	}
 #endif /* #if DT_NODE_EXISTS(DT_ALIAS(golioth_led)) */
 
+	/* Samples are buffered on the device until the Golioth client connects */
 #ifdef CONFIG_SOC_SERIES_NRF91X
 	/* Start LTE asynchronously if the nRF9160 is used.
 	 * Golioth Client will start automatically when LTE connects
@@ -214,18 +258,11 @@ int main(void)
 	lte_lc_connect_async(lte_handler);
 
 #else
-	/* If nRF9160 is not used, start the Golioth Client and block until connected */
-
-	/* Run WiFi/DHCP if necessary */
-	if (IS_ENABLED(CONFIG_GOLIOTH_SAMPLE_COMMON)) {
-		net_connect();
-	}
-
-	/* Start Golioth client */
-	start_golioth_client();
-
-	/* Block until connected to Golioth */
-	k_sem_take(&connected, K_FOREVER);
+	/* If nRF9160 is not used, connect and start the Golioth Client in a thread */
+	k_thread_create(&net_thread, net_stack, K_THREAD_STACK_SIZEOF(net_stack),
+			net_thread_entry, NULL, NULL, NULL, K_LOWEST_APPLICATION_THREAD_PRIO, 0,
+			K_NO_WAIT);
+	k_thread_name_set(&net_thread, "net_connect");
 #endif /* CONFIG_SOC_SERIES_NRF91X */
 
 	/* Set up user button */
@@ -246,51 +283,14 @@ int main(void)
 	gpio_init_callback(&button_cb_data, button_pressed, BIT(user_btn.pin));
 	gpio_add_callback(user_btn.port, &button_cb_data);
 
-	IF_ENABLED(CONFIG_LIB_OSTENTUS,(
-		/* Set up a slideshow on Ostentus
-		 *  - add up to 256 slides
-		 *  - use the enum in app_sensors.h to add new keys
-		 *  - values are updated using these keys (see app_sensors.c)
-		 */
-		ostentus_slide_add(o_dev,
-				   MOISTURE_READING_KEY,
-				   M_READING_LABEL,
-				   strlen(M_READING_LABEL));
-		ostentus_slide_add(o_dev, MOISTURE_LEVEL_KEY, M_LEVEL_LABEL, strlen(M_LEVEL_LABEL));
-		ostentus_slide_add(o_dev,
-				   MOISTURE_LIGHT_INT,
-				   M_LIGHT_INT_LABEL,
-				   strlen(M_LIGHT_INT_LABEL));
-		ostentus_slide_add(o_dev, TEMPERATURE, M_TEMP_LABEL, strlen(M_TEMP_LABEL));
-		ostentus_slide_add(o_dev, PRESSURE, M_PRESSURE_LABEL, strlen(M_PRESSURE_LABEL));
-		ostentus_slide_add(o_dev, HUMIDITY, M_HUMIDITY_LABEL, strlen(M_HUMIDITY_LABEL));
-
-		IF_ENABLED(CONFIG_ALUDEL_BATTERY_MONITOR, (
-			ostentus_slide_add(o_dev,
-					   BATTERY_V,
-					   LABEL_BATTERY,
-					   strlen(LABEL_BATTERY));
-			ostentus_slide_add(o_dev,
-					   BATTERY_PCT,
-					   LABEL_BATTERY,
-					   strlen(LABEL_BATTERY));
-		));
-		ostentus_slide_add(o_dev, FIRMWARE, LABEL_FIRMWARE, strlen(LABEL_FIRMWARE));
-
-		/* Set the title of the Ostentus summary slide (optional) */
-		ostentus_summary_title(o_dev, SUMMARY_TITLE, strlen(SUMMARY_TITLE));
-
-		/* Update the Firmware slide with the firmware version */
-		ostentus_slide_set(o_dev, FIRMWARE, (char *)_current_version,
-			  strlen(_current_version));
-
-		/* Start Ostentus slideshow with 30 second delay between slides */
-		ostentus_slideshow(o_dev, 30000);
-	));
-
 	while (true) {
-		app_sensors_read_and_stream();
+		int64_t wake_ms;
+		uint32_t tasks = app_sched_poll(&wake_ms);
+
+		if (tasks) {
+			app_sensors_read_and_stream(tasks);
+		}
 
-		k_sleep(K_SECONDS(get_loop_delay_s()));
+		k_sem_take(&wake, K_TIMEOUT_ABS_MS(wake_ms));
 	}
 }
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include "app_burst_codec.h"
+
+/* Any part length will do; the application derives its own from the upload block size */
+#define PART_LEN 100
+
+static uint32_t zigzag_decode(uint32_t value)
+{
+	return (value >> 1) ^ (0U - (value & 1));
+}
+
+/* Read one varint; return its length */
+static size_t varint_get(const uint8_t *buf, uint32_t *value)
+{
+	size_t len = 0;
+
+	*value = 0;
+	do {
+		*value |= (uint32_t)(buf[len] & 0x7f) << (7 * len);
+	} while (buf[len++] & 0x80);
+
+	return len;
+}
+
+ZTEST(burst, test_zigzag)
+{
+	zassert_equal(app_burst_zigzag(0), 0);
+	zassert_equal(app_burst_zigzag(-1), 1);
+	zassert_equal(app_burst_zigzag(1), 2);
+	zassert_equal(app_burst_zigzag(-2), 3);
+	zassert_equal(app_burst_zigzag(INT32_MAX), 0xfffffffe);
+	zassert_equal(app_burst_zigzag(INT32_MIN), 0xffffffff);
+}
+
+ZTEST(burst, test_varint)
+{
+	static const struct {
+		uint32_t value;
+		size_t len;
+		uint8_t bytes[APP_BURST_VARINT_MAX_LEN];
+	} cases[] = {
+		{0, 1, {0x00}},
+		{127, 1, {0x7f}},
+		{128, 2, {0x80, 0x01}},
+		{16383, 2, {0xff, 0x7f}},
+		{16384, 3, {0x80, 0x80, 0x01}},
+		{0xffffffff, 5, {0xff, 0xff, 0xff, 0xff, 0x0f}},
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(cases); i++) {
+		uint8_t buf[APP_BURST_VARINT_MAX_LEN];
+		uint32_t value;
+
+		zassert_equal(app_burst_varint_put(buf, cases[i].value), cases[i].len, "case %zu", i);
+		zassert_mem_equal(buf, cases[i].bytes, cases[i].len, "case %zu", i);
+		zassert_equal(varint_get(buf, &value), cases[i].len, "case %zu", i);
+		zassert_equal(value, cases[i].value, "case %zu", i);
+	}
+}
+
+ZTEST(burst, test_frame_round_trip)
+{
+	static const int32_t prev[] = {0, 1000, -1000, INT32_MAX, INT32_MIN, 12345};
+	static const int32_t frame[] = {0, 1001, -1002, INT32_MAX - 1, INT32_MIN + 1, -12345};
+	uint8_t buf[ARRAY_SIZE(frame) * APP_BURST_VARINT_MAX_LEN];
+	size_t len = app_burst_frame_encode(buf, frame, prev, ARRAY_SIZE(frame));
+	size_t offset = 0;
+
+	zassert_true(len <= sizeof(buf));
+
+	for (size_t ch = 0; ch < ARRAY_SIZE(frame); ch++) {
+		uint32_t value;
+
+		offset += varint_get(&buf[offset], &value);
+		zassert_equal((int32_t)((uint32_t)prev[ch] + zigzag_decode(value)), frame[ch],
+			      "channel %zu", ch);
+	}
+	zassert_equal(offset, len);
+}
+
+ZTEST(burst, test_frame_extreme_deltas)
+{
+	static const int32_t lo[] = {INT32_MIN};
+	static const int32_t hi[] = {INT32_MAX};
+	static const int32_t zero[] = {0};
+	uint8_t buf[APP_BURST_VARINT_MAX_LEN];
+	uint32_t value;
+
+	/* INT32_MAX - INT32_MIN wraps to -1 and INT32_MIN - INT32_MAX to 1 */
+	zassert_equal(app_burst_frame_encode(buf, hi, lo, 1), 1);
+	zassert_equal(buf[0], 0x01);
+	varint_get(buf, &value);
+	zassert_equal((int32_t)((uint32_t)lo[0] + zigzag_decode(value)), INT32_MAX);
+
+	zassert_equal(app_burst_frame_encode(buf, lo, hi, 1), 1);
+	zassert_equal(buf[0], 0x02);
+	varint_get(buf, &value);
+	zassert_equal((int32_t)((uint32_t)hi[0] + zigzag_decode(value)), INT32_MIN);
+
+	/* The largest deltas that do not wrap take the full length */
+	zassert_equal(app_burst_frame_encode(buf, hi, zero, 1), APP_BURST_VARINT_MAX_LEN);
+	zassert_equal(app_burst_frame_encode(buf, lo, zero, 1), APP_BURST_VARINT_MAX_LEN);
+}
+
+ZTEST(burst, test_parts_empty)
+{
+	/* A capture without frames is still uploaded, as one empty part */
+	zassert_equal(app_burst_part_count(0, PART_LEN), 1);
+	zassert_equal(app_burst_part_len(0, PART_LEN, 0), 0);
+}
+
+ZTEST(burst, test_parts_exact)
+{
+	zassert_equal(app_burst_part_count(PART_LEN, PART_LEN), 1);
+	zassert_equal(app_burst_part_len(PART_LEN, PART_LEN, 0), PART_LEN);
+
+	zassert_equal(app_burst_part_count(3 * PART_LEN, PART_LEN), 3);
+	for (size_t part = 0; part < 3; part++) {
+		zassert_equal(app_burst_part_len(3 * PART_LEN, PART_LEN, part), PART_LEN);
+	}
+}
+
+ZTEST(burst, test_parts_remainder)
+{
+	zassert_equal(app_burst_part_count(1, PART_LEN), 1);
+	zassert_equal(app_burst_part_len(1, PART_LEN, 0), 1);
+
+	zassert_equal(app_burst_part_count(2 * PART_LEN + 1, PART_LEN), 3);
+	zassert_equal(app_burst_part_len(2 * PART_LEN + 1, PART_LEN, 1), PART_LEN);
+	zassert_equal(app_burst_part_len(2 * PART_LEN + 1, PART_LEN, 2), 1);
+}
+
+ZTEST(burst, test_parts_cover_data)
+{
+	for (size_t data_len = 0; data_len <= 4 * PART_LEN; data_len++) {
+		size_t parts = app_burst_part_count(data_len, PART_LEN);
+		size_t total = 0;
+
+		for (size_t part = 0; part < parts; part++) {
+			size_t len = app_burst_part_len(data_len, PART_LEN, part);
+
+			/* Only the one part of an empty capture is empty */
+			zassert_true(len > 0 || data_len == 0, "data_len %zu part %zu", data_len,
+				     part);
+			total += len;
+		}
+		zassert_equal(total, data_len);
+		zassert_equal(app_burst_part_len(data_len, PART_LEN, parts), 0);
+	}
+}
+
+ZTEST_SUITE(burst, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/ztest.h>
+#include <zcbor_decode.h>
+#include <zcbor_encode.h>
+
+#include "app_history.h"
+#include "app_time.h"
+
+#define HISTORY_PARTITION_ID FIXED_PARTITION_ID(history_storage)
+
+#define UNIX_OFFSET_S 1700000000LL
+
+/* Uptime given to each test, so that it only queries entries of its own */
+#define TEST_WINDOW_S (4 * 3600)
+
+/* Room for the channel names and a few rows, and for the channel names only */
+#define PAGE_SMALL_LEN 160
+#define PAGE_TINY_LEN  96
+#define PAGE_MAX_LEN   1024
+
+#define PAGE_ROWS_MAX 32
+
+struct page {
+	uint32_t period_s;
+	size_t channels;
+	size_t rows;
+	int64_t time_s[PAGE_ROWS_MAX];
+	uint32_t count[PAGE_ROWS_MAX];
+	/* Value of the first channel in the row */
+	int32_t val[PAGE_ROWS_MAX];
+	bool more;
+	uint32_t next;
+};
+
+#define CHANNEL_INFO(_group, _key)		  {.group = _group, .key = _key},
+#define CHANNEL_INFO_X(_id, _chan, _group, _key, ...) CHANNEL_INFO(_group, _key)
+#define CHANNEL_INFO_D(_id, _group, _key, ...)	  CHANNEL_INFO(_group, _key)
+
+const struct app_channel_info app_channels[APP_CH_COUNT] = {
+	APP_CHANNELS(CHANNEL_INFO_X, CHANNEL_INFO_D)
+};
+
+static bool time_known;
+static uint32_t start_s;
+static uint32_t next_start_s;
+
+int app_time_to_unix_ms(int64_t uptime_ms, int64_t *unix_ms)
+{
+	if (!time_known) {
+		return -EAGAIN;
+	}
+
+	*unix_ms = uptime_ms + UNIX_OFFSET_S * MSEC_PER_SEC;
+
+	return 0;
+}
+
+static void add(uint32_t uptime_s, int32_t val)
+{
+	struct app_sample sample = {
+		.uptime_ms = (int64_t)uptime_s * MSEC_PER_SEC,
+		.mask = BIT(APP_CH_MOISTURE_RAW) | BIT(APP_CH_MOISTURE_LEVEL),
+	};
+
+	sample.val[APP_CH_MOISTURE_RAW] = val;
+	sample.val[APP_CH_MOISTURE_LEVEL] = 1;
+
+	app_history_add(&sample);
+}
+
+static bool key_is(const struct zcbor_string *key, const char *name)
+{
+	return (key->len == strlen(name)) && (memcmp(key->value, name, key->len) == 0);
+}
+
+static void page_decode(const uint8_t *buf, size_t len, struct page *page)
+{
+	ZCBOR_STATE_D(zsd, 3, buf, len, 1, 0);
+	struct zcbor_string str;
+	uint32_t mask;
+
+	memset(page, 0, sizeof(*page));
+
+	zassert_true(zcbor_map_start_decode(zsd));
+
+	while (!zcbor_array_at_end(zsd)) {
+		zassert_true(zcbor_tstr_decode(zsd, &str));
+
+		if (key_is(&str, "period_s")) {
+			zassert_true(zcbor_uint32_decode(zsd, &page->period_s));
+		} else if (key_is(&str, "channels")) {
+			zassert_true(zcbor_list_start_decode(zsd));
+			while (!zcbor_array_at_end(zsd)) {
+				zassert_true(zcbor_tstr_decode(zsd, &str));
+				page->channels++;
+			}
+			zassert_true(zcbor_list_end_decode(zsd));
+		} else if (key_is(&str, "rows")) {
+			zassert_true(zcbor_list_start_decode(zsd));
+			for (size_t i = 0; !zcbor_array_at_end(zsd); i++) {
+				zassert_true(i < PAGE_ROWS_MAX);
+				zassert_true(zcbor_list_start_decode(zsd));
+				zassert_true(zcbor_int64_decode(zsd, &page->time_s[i]));
+				zassert_true(zcbor_uint32_decode(zsd, &page->count[i]));
+				zassert_true(zcbor_uint32_decode(zsd, &mask));
+				zassert_equal(mask, BIT(APP_CH_MOISTURE_RAW) | BIT(APP_CH_MOISTURE_LEVEL));
+				/* Values in channel order, for the channels of the mask */
+				zassert_true(zcbor_int32_decode(zsd, &page->val[i]));
+				zassert_true(zcbor_any_skip(zsd, NULL));
+				zassert_true(zcbor_list_end_decode(zsd));
+				page->rows++;
+			}
+			zassert_true(zcbor_list_end_decode(zsd));
+		} else if (key_is(&str, "next")) {
+			page->more = true;
+			zassert_true(zcbor_uint32_decode(zsd, &page->next));
+		} else {
+			zassert_unreachable("Unexpected key %.*s", (int)str.len, str.value);
+		}
+	}
+
+	zassert_true(zcbor_map_end_decode(zsd));
+}
+
+/* Query the entries of `tier` taken in the window of the test, between uptimes */
+static int query(const char *tier, uint32_t from_s, uint32_t to_s, uint32_t cursor,
+		 size_t buf_len, struct page *page)
+{
+	static uint8_t buf[PAGE_MAX_LEN];
+	ZCBOR_STATE_E(zse, 3, buf, buf_len, 1);
+	int err;
+
+	zassert_true(zcbor_map_start_encode(zse, 4));
+
+	err = app_history_query(zse, (const uint8_t *)tier, strlen(tier), UNIX_OFFSET_S + from_s,
+				UNIX_OFFSET_S + to_s, cursor);
+	if (err) {
+		return err;
+	}
+
+	zassert_true(zcbor_map_end_encode(zse, 4));
+	page_decode(buf, zse->payload - buf, page);
+
+	return 0;
+}
+
+static int query_window(const char *tier, uint32_t cursor, size_t buf_len, struct page *page)
+{
+	return query(tier, start_s, start_s + TEST_WINDOW_S - 1, cursor, buf_len, page);
+}
+
+static void *history_setup(void)
+{
+	const struct flash_area *fa;
+
+	/* Start from an erased partition, as on a new device */
+	zassert_ok(flash_area_open(HISTORY_PARTITION_ID, &fa));
+	zassert_ok(flash_area_erase(fa, 0, fa->fa_size));
+	flash_area_close(fa);
+
+	zassert_ok(app_history_init());
+
+	return NULL;
+}
+
+static void history_before(void *fixture)
+{
+	/* Each test starts on an hour of its own; older entries stay in the tiers */
+	time_known = true;
+	start_s = next_start_s;
+	next_start_s += TEST_WINDOW_S;
+}
+
+ZTEST(history, test_unknown_tier)
+{
+	struct page page;
+
+	zassert_equal(query_window("day", 0, PAGE_MAX_LEN, &page), -EINVAL);
+}
+
+ZTEST(history, test_cursor_past_newest)
+{
+	struct page page;
+
+	add(start_s, 0);
+
+	zassert_equal(query_window("raw", UINT32_MAX, PAGE_MAX_LEN, &page), -ERANGE);
+}
+
+ZTEST(history, test_page_too_small)
+{
+	struct page page;
+
+	add(start_s, 0);
+
+	/* Not even one row fits after the channel names */
+	zassert_equal(query_window("raw", 0, PAGE_TINY_LEN, &page), -ENOMEM);
+}
+
+ZTEST(history, test_raw_pages)
+{
+	struct page page;
+	uint32_t cursor = 0;
+	int32_t expected = 12;
+	int pages = 0;
+
+	for (int i = 0; i < 20; i++) {
+		add(start_s + i, i);
+	}
+
+	/* Only the newest CONFIG_APP_HISTORY_RAW_LEN samples are kept */
+	do {
+		zassert_ok(query_window("raw", cursor, PAGE_SMALL_LEN, &page));
+		zassert_equal(page.period_s, 0);
+		zassert_equal(page.channels, (cursor == 0) ? APP_CH_COUNT : 0);
+		zassert_true(page.rows > 0, "Empty page %d", pages);
+
+		for (size_t i = 0; i < page.rows; i++) {
+			zassert_equal(page.val[i], expected);
+			zassert_equal(page.time_s[i], UNIX_OFFSET_S + start_s + expected);
+			zassert_equal(page.count[i], 1);
+			expected++;
+		}
+
+		cursor = page.next;
+		pages++;
+	} while (page.more);
+
+	zassert_equal(expected, 20);
+	zassert_true(pages > 1, "Not paged");
+}
+
+ZTEST(history, test_pages_across_wrap)
+{
+	struct page page;
+
+	for (int i = 0; i < CONFIG_APP_HISTORY_RAW_LEN; i++) {
+		add(start_s + i, i);
+	}
+
+	zassert_ok(query_window("raw", 0, PAGE_SMALL_LEN, &page));
+	zassert_true(page.more);
+	zassert_true(page.rows <= CONFIG_APP_HISTORY_RAW_LEN / 2);
+	zassert_equal(page.val[0], 0);
+	zassert_equal(page.val[page.rows - 1], page.rows - 1);
+
+	/* Overwrite the first half, including the entry the cursor points to */
+	for (int i = 0; i < CONFIG_APP_HISTORY_RAW_LEN / 2; i++) {
+		add(start_s + CONFIG_APP_HISTORY_RAW_LEN + i, CONFIG_APP_HISTORY_RAW_LEN + i);
+	}
+
+	/* The next page resumes at the oldest entry still kept */
+	zassert_ok(query_window("raw", page.next, PAGE_MAX_LEN, &page));
+	zassert_false(page.more);
+	zassert_equal(page.rows, CONFIG_APP_HISTORY_RAW_LEN);
+	for (size_t i = 0; i < page.rows; i++) {
+		zassert_equal(page.val[i], CONFIG_APP_HISTORY_RAW_LEN / 2 + i);
+	}
+}
+
+ZTEST(history, test_from_to)
+{
+	struct page page;
+
+	for (int i = 0; i < 8; i++) {
+		add(start_s + i, i);
+	}
+
+	zassert_ok(query("raw", start_s + 3, start_s + 6, 0, PAGE_MAX_LEN, &page));
+	zassert_equal(page.rows, 4);
+	for (size_t i = 0; i < page.rows; i++) {
+		zassert_equal(page.val[i], 3 + i);
+	}
+}
+
+ZTEST(history, test_no_time_base)
+{
+	struct page page;
+
+	time_known = false;
+	for (int i = 0; i < 3; i++) {
+		add(start_s + i, i);
+	}
+
+	/* Left out until network time is known */
+	zassert_ok(query_window("raw", 0, PAGE_MAX_LEN, &page));
+	zassert_equal(page.rows, 0);
+
+	/* Then converted with the time base current at the query */
+	time_known = true;
+	zassert_ok(query_window("raw", 0, PAGE_MAX_LEN, &page));
+	zassert_equal(page.rows, 3);
+	zassert_equal(page.time_s[0], UNIX_OFFSET_S + start_s);
+}
+
+ZTEST(history, test_minute_means)
+{
+	struct page page;
+
+	/* Six samples a minute for three minutes, then one to close the third */
+	for (int m = 0; m < 3; m++) {
+		for (int k = 0; k < 6; k++) {
+			add(start_s + m * 60 + k * 10, m * 100 + k * 10);
+		}
+	}
+	add(start_s + 180, 0);
+
+	zassert_ok(query_window("minute", 0, PAGE_MAX_LEN, &page));
+	zassert_equal(page.period_s, 60);
+	zassert_equal(page.rows, 3);
+	for (int m = 0; m < 3; m++) {
+		zassert_equal(page.time_s[m], UNIX_OFFSET_S + start_s + m * 60);
+		zassert_equal(page.count[m], 6);
+		zassert_equal(page.val[m], m * 100 + 25);
+	}
+}
+
+ZTEST(history, test_minute_mean_rounding)
+{
+	struct page page;
+
+	/* Means of -2.5 and 2.5 round away from zero */
+	add(start_s, -2);
+	add(start_s + 1, -3);
+	add(start_s + 60, 2);
+	add(start_s + 61, 3);
+	add(start_s + 120, 0);
+
+	zassert_ok(query_window("minute", 0, PAGE_MAX_LEN, &page));
+	zassert_equal(page.rows, 2);
+	zassert_equal(page.val[0], -3);
+	zassert_equal(page.val[1], 3);
+}
+
+ZTEST(history, test_hour_means_restored)
+{
+	struct page before;
+	struct page after;
+
+	/* One sample a minute: 10 for an hour, then 20 */
+	for (int m = 0; m < 122; m++) {
+		add(start_s + m * 60, (m < 60) ? 10 : 20);
+	}
+
+	/* Minute 121 closed minute 120, which is in a new hour */
+	zassert_ok(query_window("hour", 0, PAGE_MAX_LEN, &before));
+	zassert_equal(before.period_s, 3600);
+	zassert_equal(before.rows, 2);
+	zassert_equal(before.time_s[0], UNIX_OFFSET_S + start_s);
+	zassert_equal(before.time_s[1], UNIX_OFFSET_S + start_s + 3600);
+	zassert_equal(before.count[0], 60);
+	zassert_equal(before.count[1], 60);
+	zassert_equal(before.val[0], 10);
+	zassert_equal(before.val[1], 20);
+
+	/* Read the partition back the way a reboot would: both hours come back */
+	zassert_ok(app_history_init());
+
+	zassert_ok(query_window("hour", 0, PAGE_MAX_LEN, &after));
+	zassert_equal(after.rows, 2 * before.rows);
+	for (size_t i = 0; i < before.rows; i++) {
+		zassert_equal(after.time_s[before.rows + i], before.time_s[i]);
+		zassert_equal(after.count[before.rows + i], before.count[i]);
+		zassert_equal(after.val[before.rows + i], before.val[i]);
+	}
+}
+
+ZTEST_SUITE(history, NULL, history_setup, history_before, NULL, NULL);
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT st_lis2dh
+
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+
+#include "lis2dh_emul.h"
+
+#define REG_WHO_AM_I 0x0F
+#define WHO_AM_I_LIS2DH 0x33
+#define REG_CTRL5 0x24
+#define CTRL5_FIFO_EN BIT(6)
+#define REG_OUT_X_L 0x28
+#define REG_OUT_Z_H 0x2D
+#define REG_FIFO_SRC 0x2F
+#define FIFO_SRC_OVRN BIT(6)
+#define FIFO_SRC_EMPTY BIT(5)
+#define FIFO_SRC_FSS_MASK BIT_MASK(5)
+
+#define REG_COUNT 0x40
+#define REG_MASK BIT_MASK(7)
+#define REG_AUTO_INCREMENT BIT(7)
+
+#define FIFO_DEPTH 32
+#define SAMPLE_LEN 6
+
+/* High resolution: 12-bit samples, left-justified */
+#define SAMPLE_SHIFT 4
+
+struct lis2dh_emul_data {
+	uint8_t regs[REG_COUNT];
+	uint8_t fifo[FIFO_DEPTH][SAMPLE_LEN];
+	size_t head;
+	size_t count;
+	bool overrun;
+	/* Register pointer, and whether it moves after each byte */
+	uint8_t ptr;
+	bool auto_inc;
+};
+
+void lis2dh_emul_push(const struct emul *target, int16_t x_mg, int16_t y_mg, int16_t z_mg)
+{
+	struct lis2dh_emul_data *data = target->data;
+	uint8_t *sample;
+
+	if (data->count == FIFO_DEPTH) {
+		data->head = (data->head + 1) % FIFO_DEPTH;
+		data->count--;
+		data->overrun = true;
+	}
+
+	sample = data->fifo[(data->head + data->count) % FIFO_DEPTH];
+	sys_put_le16((uint16_t)(x_mg << SAMPLE_SHIFT), &sample[0]);
+	sys_put_le16((uint16_t)(y_mg << SAMPLE_SHIFT), &sample[2]);
+	sys_put_le16((uint16_t)(z_mg << SAMPLE_SHIFT), &sample[4]);
+	data->count++;
+}
+
+void lis2dh_emul_reset(const struct emul *target)
+{
+	struct lis2dh_emul_data *data = target->data;
+
+	data->head = 0;
+	data->count = 0;
+	data->overrun = false;
+}
+
+uint8_t lis2dh_emul_reg_get(const struct emul *target, uint8_t reg)
+{
+	struct lis2dh_emul_data *data = target->data;
+
+	return data->regs[reg & REG_MASK];
+}
+
+void lis2dh_emul_reg_set(const struct emul *target, uint8_t reg, uint8_t val)
+{
+	struct lis2dh_emul_data *data = target->data;
+
+	data->regs[reg & REG_MASK] = val;
+}
+
+static uint8_t fifo_src(struct lis2dh_emul_data *data)
+{
+	if (data->count == 0) {
+		return FIFO_SRC_EMPTY;
+	}
+
+	/* Like the device, OVRN stays set while the FIFO is full */
+	if ((data->count == FIFO_DEPTH) || data->overrun) {
+		return FIFO_SRC_OVRN | (data->count & FIFO_SRC_FSS_MASK);
+	}
+
+	return data->count;
+}
+
+static uint8_t reg_read(struct lis2dh_emul_data *data)
+{
+	uint8_t reg = data->ptr;
+	uint8_t val;
+
+	if ((reg >= REG_OUT_X_L) && (reg <= REG_OUT_Z_H) && (data->regs[REG_CTRL5] & CTRL5_FIFO_EN)) {
+		val = data->count ? data->fifo[data->head][reg - REG_OUT_X_L] : 0;
+
+		/* Reading OUT_Z_H pops the sample and wraps back to OUT_X_L */
+		if (reg == REG_OUT_Z_H) {
+			if (data->count) {
+				data->head = (data->head + 1) % FIFO_DEPTH;
+				data->count--;
+				data->overrun = false;
+			}
+			data->ptr = REG_OUT_X_L;
+			return val;
+		}
+	} else if (reg == REG_FIFO_SRC) {
+		val = fifo_src(data);
+	} else {
+		val = data->regs[reg];
+	}
+
+	if (data->auto_inc) {
+		data->ptr = (data->ptr + 1) % REG_COUNT;
+	}
+
+	return val;
+}
+
+static void reg_write(struct lis2dh_emul_data *data, uint8_t val)
+{
+	/* Read-only registers keep their value */
+	if ((data->ptr != REG_WHO_AM_I) && (data->ptr != REG_FIFO_SRC)) {
+		data->regs[data->ptr] = val;
+	}
+
+	if (data->auto_inc) {
+		data->ptr = (data->ptr + 1) % REG_COUNT;
+	}
+}
+
+static int lis2dh_emul_transfer(const struct emul *target, struct i2c_msg *msgs, int num_msgs,
+				int addr)
+{
+	struct lis2dh_emul_data *data = target->data;
+	bool addressed = false;
+
+	for (int i = 0; i < num_msgs; i++) {
+		struct i2c_msg *msg = &msgs[i];
+		size_t start = 0;
+
+		if (msg->flags & I2C_MSG_READ) {
+			if (!addressed) {
+				return -EIO;
+			}
+
+			for (size_t n = 0; n < msg->len; n++) {
+				msg->buf[n] = reg_read(data);
+			}
+			continue;
+		}
+
+		/* The first byte written after a start selects the register */
+		if (!addressed) {
+			if (msg->len == 0) {
+				return -EIO;
+			}
+
+			data->ptr = msg->buf[0] & REG_MASK;
+			data->auto_inc = msg->buf[0] & REG_AUTO_INCREMENT;
+			if (data->ptr >= REG_COUNT) {
+				return -EIO;
+			}
+			addressed = true;
+			start = 1;
+		}
+
+		for (size_t n = start; n < msg->len; n++) {
+			reg_write(data, msg->buf[n]);
+		}
+	}
+
+	return 0;
+}
+
+static const struct i2c_emul_api lis2dh_emul_api = {
+	.transfer = lis2dh_emul_transfer,
+};
+
+static int lis2dh_emul_init(const struct emul *target, const struct device *parent)
+{
+	struct lis2dh_emul_data *data = target->data;
+
+	memset(data, 0, sizeof(*data));
+	data->regs[REG_WHO_AM_I] = WHO_AM_I_LIS2DH;
+
+	return 0;
+}
+
+#define LIS2DH_EMUL(n)                                                                             \
+	static struct lis2dh_emul_data lis2dh_emul_data_##n;                                       \
+	EMUL_DT_INST_DEFINE(n, lis2dh_emul_init, &lis2dh_emul_data_##n, NULL, &lis2dh_emul_api,    \
+			    NULL)
+
+DT_INST_FOREACH_STATUS_OKAY(LIS2DH_EMUL)
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * I2C emulator of the LIS2DH: a register file with the 32-sample FIFO in
+ * stream mode behind the output registers. Samples are pushed in mg; the
+ * driver must be configured for 1 mg per digit (high resolution, 2 g).
+ */
+
+#ifndef __LIS2DH_EMUL_H__
+#define __LIS2DH_EMUL_H__
+
+#include <stdint.h>
+#include <zephyr/drivers/emul.h>
+
+/** Add a sample to the FIFO; the oldest one is overwritten when it is full */
+void lis2dh_emul_push(const struct emul *target, int16_t x_mg, int16_t y_mg, int16_t z_mg);
+
+/** Empty the FIFO and clear its overrun flag */
+void lis2dh_emul_reset(const struct emul *target);
+
+uint8_t lis2dh_emul_reg_get(const struct emul *target, uint8_t reg);
+
+void lis2dh_emul_reg_set(const struct emul *target, uint8_t reg, uint8_t val);
+
+#endif /* __LIS2DH_EMUL_H__ */
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/ztest.h>
+
+#include "app_imu.h"
+#include "app_sched.h"
+#include "lis2dh_emul.h"
+
+#define LIS2DH_NODE DT_NODELABEL(lis2dh)
+
+#define REG_CTRL4 0x23
+#define CTRL4_FS_MASK (BIT_MASK(2) << 4)
+#define CTRL4_HR BIT(3)
+#define REG_INT1_SRC 0x31
+#define REG_INT2_SRC 0x35
+/* IA, with the high event of each axis */
+#define INT_SRC_MOTION 0x6A
+
+/* mg to milli m/s^2, as reported */
+#define MG(_mg) ((int32_t)(((int64_t)(_mg) * SENSOR_G) / 1000000))
+
+/* Time for the FIFO to fill to 3/4 at the default rate, and a second more */
+#define FIFO_POLL_WAIT K_MSEC((24 + CONFIG_APP_IMU_ODR_HZ) * MSEC_PER_SEC / CONFIG_APP_IMU_ODR_HZ)
+
+static const struct emul *emul = EMUL_DT_GET(LIS2DH_NODE);
+static const struct gpio_dt_spec int2 = GPIO_DT_SPEC_GET_BY_IDX(LIS2DH_NODE, irq_gpios, 1);
+
+static atomic_t requested;
+
+/* Called from the motion handler of app_imu.c */
+void app_sched_request(uint32_t tasks)
+{
+	atomic_or(&requested, tasks);
+}
+
+static void *imu_setup(void)
+{
+	zassert_ok(app_imu_init(DEVICE_DT_GET(LIS2DH_NODE)));
+
+	/* The emulator stores samples at 1 mg per digit */
+	zassert_equal(lis2dh_emul_reg_get(emul, REG_CTRL4) & (CTRL4_FS_MASK | CTRL4_HR), CTRL4_HR,
+		      "Driver is not in high resolution, 2 g mode");
+
+	return NULL;
+}
+
+static void imu_before(void *fixture)
+{
+	struct app_imu_window window;
+
+	/* Start each test with an empty FIFO and window */
+	lis2dh_emul_reset(emul);
+	(void)app_imu_fifo_drain(&window);
+	atomic_clear(&requested);
+}
+
+ZTEST(imu, test_drain_empty)
+{
+	struct app_imu_window window;
+
+	zassert_equal(app_imu_fifo_drain(&window), -ENODATA);
+}
+
+ZTEST(imu, test_drain_mean_and_p2p)
+{
+	struct app_imu_window window;
+
+	lis2dh_emul_push(emul, 0, 0, 1000);
+	lis2dh_emul_push(emul, 100, -40, 1000);
+	lis2dh_emul_push(emul, -100, 40, 1000);
+	lis2dh_emul_push(emul, 0, 0, 1000);
+
+	zassert_equal(app_imu_fifo_drain(&window), 4);
+	zassert_equal(window.count, 4);
+	zassert_equal(window.overruns, 0);
+	zassert_equal(window.mean[0], 0);
+	zassert_equal(window.mean[1], 0);
+	zassert_equal(window.mean[2], MG(1000));
+	/* The swing of X, not averaged away by the mean */
+	zassert_equal(window.p2p, MG(200));
+
+	/* Drained samples are not reported twice */
+	zassert_equal(app_imu_fifo_drain(&window), -ENODATA);
+}
+
+ZTEST(imu, test_overrun_reported)
+{
+	struct app_imu_window window;
+
+	for (int i = 0; i < 40; i++) {
+		lis2dh_emul_push(emul, i, 0, 1000);
+	}
+
+	zassert_equal(app_imu_fifo_drain(&window), 32);
+	zassert_equal(window.overruns, 1);
+	/* Only the newest 32 samples were left: 8 to 39 */
+	zassert_equal(window.p2p, MG(31));
+}
+
+ZTEST(imu, test_poll_keeps_every_sample)
+{
+	struct app_imu_window window;
+
+	/* A knock early in a long loop period */
+	lis2dh_emul_push(emul, 0, 0, 1000);
+	lis2dh_emul_push(emul, 0, 0, 1800);
+	for (int i = 0; i < 18; i++) {
+		lis2dh_emul_push(emul, 0, 0, 1000);
+	}
+
+	/* The poll work reads the FIFO before it fills up */
+	k_sleep(FIFO_POLL_WAIT);
+
+	for (int i = 0; i < 20; i++) {
+		lis2dh_emul_push(emul, 0, 0, 1000);
+	}
+
+	zassert_equal(app_imu_fifo_drain(&window), 40);
+	zassert_equal(window.overruns, 0);
+	zassert_equal(window.mean[2], MG(1020));
+	zassert_equal(window.p2p, MG(800));
+}
+
+ZTEST(imu, test_burst_samples_count_towards_drain)
+{
+	struct app_imu_window window;
+	int32_t accel[3];
+
+	lis2dh_emul_push(emul, 0, 500, 1000);
+	lis2dh_emul_push(emul, 0, 300, 1000);
+
+	zassert_equal(app_imu_fifo_sample(accel), 2);
+	zassert_equal(accel[1], MG(400));
+
+	lis2dh_emul_push(emul, 0, 400, 1000);
+
+	zassert_equal(app_imu_fifo_drain(&window), 3);
+	zassert_equal(window.mean[1], MG(400));
+	zassert_equal(window.p2p, MG(200));
+}
+
+ZTEST(imu, test_motion_interrupt)
+{
+	uint32_t count = app_imu_motion_count();
+
+	lis2dh_emul_reg_set(emul, REG_INT1_SRC, INT_SRC_MOTION);
+	lis2dh_emul_reg_set(emul, REG_INT2_SRC, INT_SRC_MOTION);
+
+	zassert_ok(gpio_emul_input_set(int2.port, int2.pin, 1));
+	/* The driver handles the interrupt on its global work thread */
+	k_sleep(K_MSEC(100));
+	zassert_ok(gpio_emul_input_set(int2.port, int2.pin, 0));
+
+	zassert_equal(app_imu_motion_count(), count + 1);
+	zassert_true(atomic_get(&requested) & BIT(APP_TASK_IMU), "IMU read not requested");
+}
+
+ZTEST_SUITE(imu, NULL, imu_setup, imu_before, NULL, NULL);
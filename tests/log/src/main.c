@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <zephyr/ztest.h>
+
+#include "app_log_batch.h"
+
+/* 12 records per minute, bursts of 6 */
+#define INTERVAL_MS 5000
+#define BURST 6
+
+#define BATCH_LEN 64
+#define RECORD_LEN 20
+
+static uint8_t batch_buf[BATCH_LEN];
+static struct app_log_batch batch;
+static uint8_t record[RECORD_LEN];
+
+static void log_before(void *fixture)
+{
+	memset(batch_buf, 0, sizeof(batch_buf));
+	batch = (struct app_log_batch){
+		.buf = batch_buf,
+		.size = sizeof(batch_buf),
+	};
+	memset(record, 'a', sizeof(record));
+}
+
+ZTEST(log, test_rate_burst)
+{
+	int64_t tat = 0;
+
+	for (int i = 0; i < BURST; i++) {
+		zassert_true(app_log_rate_allow(&tat, 1000, INTERVAL_MS, BURST), "record %d", i);
+	}
+
+	zassert_false(app_log_rate_allow(&tat, 1000, INTERVAL_MS, BURST));
+	/* A denied record does not use up the allowance */
+	zassert_equal(tat, 1000 + BURST * INTERVAL_MS);
+}
+
+ZTEST(log, test_rate_sustained)
+{
+	int64_t tat = 0;
+	int64_t now = 0;
+
+	for (int i = 0; i < BURST; i++) {
+		zassert_true(app_log_rate_allow(&tat, now, INTERVAL_MS, BURST));
+	}
+
+	/* Then one record per interval, not before */
+	for (int i = 0; i < 10; i++) {
+		now += INTERVAL_MS - 1;
+		zassert_false(app_log_rate_allow(&tat, now, INTERVAL_MS, BURST), "period %d", i);
+		now += 1;
+		zassert_true(app_log_rate_allow(&tat, now, INTERVAL_MS, BURST), "period %d", i);
+	}
+}
+
+ZTEST(log, test_rate_quiet_restores_burst)
+{
+	int64_t tat = 0;
+
+	for (int i = 0; i < BURST; i++) {
+		zassert_true(app_log_rate_allow(&tat, 0, INTERVAL_MS, BURST));
+	}
+	zassert_false(app_log_rate_allow(&tat, 0, INTERVAL_MS, BURST));
+
+	/* A long quiet period earns one burst, not more */
+	for (int i = 0; i < BURST; i++) {
+		zassert_true(app_log_rate_allow(&tat, 3600000, INTERVAL_MS, BURST));
+	}
+	zassert_false(app_log_rate_allow(&tat, 3600000, INTERVAL_MS, BURST));
+}
+
+ZTEST(log, test_rate_no_burst)
+{
+	int64_t tat = 0;
+
+	zassert_true(app_log_rate_allow(&tat, 0, INTERVAL_MS, 1));
+	zassert_false(app_log_rate_allow(&tat, INTERVAL_MS - 1, INTERVAL_MS, 1));
+	zassert_true(app_log_rate_allow(&tat, INTERVAL_MS, INTERVAL_MS, 1));
+}
+
+ZTEST(log, test_batch_append)
+{
+	zassert_false(app_log_batch_add(&batch, record, RECORD_LEN, true));
+	record[0] = 'b';
+	zassert_false(app_log_batch_add(&batch, record, RECORD_LEN, true));
+
+	zassert_equal(batch.len, 2 * RECORD_LEN);
+	zassert_equal(batch.records, 2);
+	zassert_equal(batch.dropped, 0);
+	zassert_equal(batch_buf[0], 'a');
+	zassert_equal(batch_buf[RECORD_LEN], 'b');
+}
+
+ZTEST(log, test_batch_upload_when_nearly_full)
+{
+	zassert_false(app_log_batch_add(&batch, record, RECORD_LEN, true));
+	zassert_false(app_log_batch_add(&batch, record, RECORD_LEN, true));
+	/* 4 bytes left: a record as long as this one would not fit */
+	zassert_true(app_log_batch_add(&batch, record, RECORD_LEN, true));
+	zassert_equal(batch.records, 3);
+
+	/* A short one still does */
+	zassert_true(app_log_batch_add(&batch, record, 4, true));
+	zassert_equal(batch.len, BATCH_LEN);
+	zassert_equal(batch.dropped, 0);
+}
+
+ZTEST(log, test_batch_full_connected)
+{
+	for (int i = 0; i < 3; i++) {
+		app_log_batch_add(&batch, record, RECORD_LEN, true);
+	}
+
+	/* The batch is kept for the upload about to happen; the record is lost */
+	record[0] = 'z';
+	zassert_true(app_log_batch_add(&batch, record, RECORD_LEN, true));
+	zassert_equal(batch.records, 3);
+	zassert_equal(batch.len, 3 * RECORD_LEN);
+	zassert_equal(batch.dropped, 1);
+	zassert_equal(batch_buf[0], 'a');
+}
+
+ZTEST(log, test_batch_full_offline)
+{
+	for (int i = 0; i < 3; i++) {
+		app_log_batch_add(&batch, record, RECORD_LEN, false);
+	}
+
+	/* The old records make room for the most recent one */
+	record[0] = 'z';
+	zassert_false(app_log_batch_add(&batch, record, RECORD_LEN, false));
+	zassert_equal(batch.records, 1);
+	zassert_equal(batch.len, RECORD_LEN);
+	zassert_equal(batch.dropped, 3);
+	zassert_equal(batch_buf[0], 'z');
+}
+
+ZTEST(log, test_batch_record_too_long)
+{
+	static uint8_t long_record[BATCH_LEN + 1];
+
+	app_log_batch_add(&batch, record, RECORD_LEN, false);
+
+	zassert_false(app_log_batch_add(&batch, long_record, sizeof(long_record), false));
+	zassert_equal(batch.records, 1);
+	zassert_equal(batch.dropped, 1);
+}
+
+ZTEST(log, test_batch_reset)
+{
+	for (int i = 0; i < 4; i++) {
+		app_log_batch_add(&batch, record, RECORD_LEN, true);
+	}
+
+	app_log_batch_reset(&batch);
+
+	zassert_equal(batch.len, 0);
+	zassert_equal(batch.records, 0);
+	zassert_equal(batch.dropped, 0);
+	zassert_false(app_log_batch_add(&batch, record, RECORD_LEN, true));
+}
+
+ZTEST_SUITE(log, NULL, NULL, log_before, NULL, NULL);
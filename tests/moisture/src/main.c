@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include "app_moisture.h"
+
+/* Burst and EMA weight of the default configuration */
+#define BENCH_OVERSAMPLE 8
+#define BENCH_TRIM 2
+#define BENCH_EMA_SHIFT 2
+#define BENCH_ROUNDS 1000
+
+ZTEST(moisture, test_burst_median)
+{
+	uint16_t odd[] = {2000, 10, 2003, 4095, 2001};
+	uint16_t even[] = {1000, 1003, 0, 4095};
+
+	/* A trim of (count - 1) / 2 or more keeps the middle value(s) */
+	zassert_equal(moisture_burst_reduce(odd, ARRAY_SIZE(odd), 2), 2001);
+	zassert_equal(moisture_burst_reduce(odd, ARRAY_SIZE(odd), 16), 2001);
+	zassert_equal(moisture_burst_reduce(even, ARRAY_SIZE(even), 16), 1002);
+}
+
+ZTEST(moisture, test_burst_trimmed_mean)
+{
+	uint16_t spikes[] = {4095, 100, 101, 0, 103, 102};
+	uint16_t plain[] = {10, 20, 30};
+
+	zassert_equal(moisture_burst_reduce(spikes, ARRAY_SIZE(spikes), 1), 102);
+	zassert_equal(moisture_burst_reduce(plain, ARRAY_SIZE(plain), 0), 20);
+
+	/* Sorted in place */
+	for (size_t i = 1; i < ARRAY_SIZE(spikes); i++) {
+		zassert_true(spikes[i - 1] <= spikes[i]);
+	}
+}
+
+ZTEST(moisture, test_burst_edges)
+{
+	uint16_t one[] = {1234};
+	uint16_t full[] = {4095, 4095, 4095, 4095};
+
+	zassert_equal(moisture_burst_reduce(one, 0, 0), 0);
+	zassert_equal(moisture_burst_reduce(one, ARRAY_SIZE(one), 3), 1234);
+	zassert_equal(moisture_burst_reduce(full, ARRAY_SIZE(full), 0), MOISTURE_ADC_MAX);
+}
+
+ZTEST(moisture, test_filter_prime_and_passthrough)
+{
+	struct moisture_filter filter;
+
+	moisture_filter_reset(&filter);
+
+	/* The first value primes the filter */
+	zassert_equal(moisture_filter_update(&filter, 1000, 2), 1000);
+	zassert_equal(moisture_filter_update(&filter, 2000, 2), 1250);
+
+	/* A shift of 0 disables smoothing */
+	zassert_equal(moisture_filter_update(&filter, 3000, 0), 3000);
+
+	/* After a reset the next value primes it again */
+	moisture_filter_reset(&filter);
+	zassert_equal(moisture_filter_update(&filter, 500, 4), 500);
+}
+
+ZTEST(moisture, test_filter_carry_over)
+{
+	struct moisture_filter filter;
+	uint16_t out = 0;
+	int n;
+
+	moisture_filter_reset(&filter);
+	moisture_filter_update(&filter, 1000, 4);
+
+	/*
+	 * A one-count step is below the weight of a single update; the
+	 * fractional bits carry it until the output moves.
+	 */
+	for (n = 0; n < 64 && out != 1001; n++) {
+		out = moisture_filter_update(&filter, 1001, 4);
+	}
+
+	zassert_equal(out, 1001, "Stuck at %u", out);
+	zassert_true(n > 1, "Step passed through unsmoothed");
+}
+
+ZTEST(moisture, test_filter_clamping)
+{
+	struct moisture_filter filter;
+	uint16_t out;
+
+	moisture_filter_reset(&filter);
+	moisture_filter_update(&filter, MOISTURE_ADC_MAX, 8);
+
+	/* Full-scale swings stay within the ADC range */
+	for (int i = 0; i < 256; i++) {
+		out = moisture_filter_update(&filter, (i & 1) ? MOISTURE_ADC_MAX : 0, 8);
+		zassert_true(out <= MOISTURE_ADC_MAX);
+	}
+
+	for (int i = 0; i < 4096; i++) {
+		out = moisture_filter_update(&filter, 0, 8);
+	}
+	zassert_equal(out, 0);
+
+	for (int i = 0; i < 4096; i++) {
+		out = moisture_filter_update(&filter, MOISTURE_ADC_MAX, 8);
+	}
+	zassert_equal(out, MOISTURE_ADC_MAX);
+}
+
+ZTEST(moisture, test_filter_benchmark)
+{
+	struct moisture_filter filter;
+	uint16_t burst[BENCH_OVERSAMPLE];
+	uint32_t min = UINT32_MAX;
+	uint32_t max = 0;
+	uint64_t total = 0;
+
+	moisture_filter_reset(&filter);
+
+	for (int r = 0; r < BENCH_ROUNDS; r++) {
+		uint32_t start;
+		uint32_t cycles;
+
+		/* Noisy burst around mid-scale with one spike */
+		for (int i = 0; i < BENCH_OVERSAMPLE; i++) {
+			burst[i] = 2048 + ((r * 7 + i * 13) % 32) - 16;
+		}
+		burst[r % BENCH_OVERSAMPLE] = MOISTURE_ADC_MAX;
+
+		start = k_cycle_get_32();
+		moisture_filter_update(&filter,
+				       moisture_burst_reduce(burst, ARRAY_SIZE(burst), BENCH_TRIM),
+				       BENCH_EMA_SHIFT);
+		cycles = k_cycle_get_32() - start;
+
+		min = MIN(min, cycles);
+		max = MAX(max, cycles);
+		total += cycles;
+	}
+
+	TC_PRINT("Filter kernel, %d conversions: min %u, mean %u, max %u cycles at %u Hz\n",
+		 BENCH_OVERSAMPLE, min, (uint32_t)(total / BENCH_ROUNDS), max,
+		 sys_clock_hw_cycles_per_sec());
+}
+
+ZTEST_SUITE(moisture, NULL, NULL, NULL, NULL, NULL);
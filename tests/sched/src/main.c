@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "main.h"
+#include "app_sched.h"
+#include "app_settings.h"
+
+#define SLOT_MS (10 * MSEC_PER_SEC)
+#define DAY_MS (24 * 3600 * MSEC_PER_SEC)
+/* Longest wake-up latency simulated */
+#define LATE_MAX_MS 2500
+
+/* Used by app_sched_poll(), which these tests do not call */
+void wake_system_thread(void)
+{
+}
+
+void app_config_get(struct app_config *cfg)
+{
+	memset(cfg, 0, sizeof(*cfg));
+}
+
+int32_t app_config_task_period_s(const struct app_config *cfg, enum app_task task)
+{
+	return 60;
+}
+
+struct run_log {
+	/* Runs of each task, and the period index of the last one */
+	uint32_t runs[APP_TASK_COUNT];
+	int64_t last_k[APP_TASK_COUNT];
+	/* Calls that returned at least one task */
+	uint32_t wakeups;
+	/* Largest delay of a run after its due time */
+	int64_t jitter_max_ms;
+};
+
+static uint32_t lcg_state;
+
+static uint32_t lcg_next(void)
+{
+	lcg_state = lcg_state * 1664525u + 1013904223u;
+	return lcg_state >> 8;
+}
+
+static void tasks_init(struct app_sched_task *tasks, size_t count, const int64_t *period_s,
+		       const int64_t *phase_s)
+{
+	memset(tasks, 0, count * sizeof(*tasks));
+
+	for (size_t i = 0; i < count; i++) {
+		app_sched_task_set_period(&tasks[i], period_s[i] * MSEC_PER_SEC,
+					  phase_s ? phase_s[i] * MSEC_PER_SEC : 0, 0);
+	}
+}
+
+/*
+ * Run the schedule from boot to `end_ms`, waking up to `late_max_ms` after the
+ * time asked for, and check every run against the grid of its task.
+ */
+static void simulate(struct app_sched_task *tasks, size_t count, int64_t end_ms,
+		     int64_t late_max_ms, struct run_log *log)
+{
+	int64_t now_ms = 0;
+	int64_t next_ms;
+	uint32_t due;
+
+	memset(log, 0, sizeof(*log));
+	lcg_state = 1;
+
+	for (size_t i = 0; i < count; i++) {
+		log->last_k[i] = tasks[i].last_period;
+	}
+
+	/* The first call computes the first wake-up; nothing is due yet */
+	zassert_equal(app_sched_due(tasks, count, SLOT_MS, now_ms, &next_ms), 0);
+
+	while (true) {
+		now_ms = next_ms + (late_max_ms ? (lcg_next() % late_max_ms) : 0);
+		if (now_ms > end_ms) {
+			break;
+		}
+
+		due = app_sched_due(tasks, count, SLOT_MS, now_ms, &next_ms);
+		zassert_not_equal(due, 0, "Woken at %lld for nothing", now_ms);
+		zassert_true(next_ms > now_ms);
+		log->wakeups++;
+
+		for (size_t i = 0; i < count; i++) {
+			int64_t k = log->last_k[i] + 1;
+			int64_t due_ms = tasks[i].phase_ms + k * tasks[i].period_ms;
+
+			if (!(due & BIT(i))) {
+				continue;
+			}
+
+			/* Each period runs once, late by at most a slot and the latency */
+			zassert_equal(tasks[i].last_period, k, "Task %zu skipped a period", i);
+			zassert_true(now_ms >= due_ms, "Task %zu early", i);
+			zassert_true(now_ms - due_ms < SLOT_MS + late_max_ms,
+				     "Task %zu late by %lld ms", i, now_ms - due_ms);
+
+			log->jitter_max_ms = MAX(log->jitter_max_ms, now_ms - due_ms);
+			log->last_k[i] = k;
+			log->runs[i]++;
+		}
+	}
+}
+
+ZTEST(sched, test_jitter)
+{
+	static const int64_t period_s[] = {60, 300, 600, 3600, 45};
+	struct app_sched_task tasks[ARRAY_SIZE(period_s)];
+	struct run_log log;
+
+	tasks_init(tasks, ARRAY_SIZE(tasks), period_s, NULL);
+	simulate(tasks, ARRAY_SIZE(tasks), DAY_MS, LATE_MAX_MS, &log);
+
+	/* Lateness does not accumulate: every period of the day ran */
+	for (size_t i = 0; i < ARRAY_SIZE(period_s); i++) {
+		int64_t expected = DAY_MS / (period_s[i] * MSEC_PER_SEC);
+
+		zassert_within(log.runs[i], expected, 1, "Task %zu ran %u times", i, log.runs[i]);
+	}
+
+	TC_PRINT("Largest delay after the due time: %lld ms\n", log.jitter_max_ms);
+}
+
+ZTEST(sched, test_slot_coalescing)
+{
+	/* README example: weather, moisture and battery */
+	static const int64_t period_s[] = {300, 600, 3600};
+	struct app_sched_task tasks[ARRAY_SIZE(period_s)];
+	struct run_log log;
+
+	tasks_init(tasks, ARRAY_SIZE(tasks), period_s, NULL);
+	simulate(tasks, ARRAY_SIZE(tasks), DAY_MS, LATE_MAX_MS, &log);
+
+	/* Moisture and battery never wake the device on their own */
+	zassert_equal(log.wakeups, log.runs[0]);
+	zassert_within(log.runs[0], DAY_MS / (300 * MSEC_PER_SEC), 1);
+	zassert_within(log.runs[1], DAY_MS / (600 * MSEC_PER_SEC), 1);
+	zassert_within(log.runs[2], 24, 1);
+}
+
+ZTEST(sched, test_period_below_slot)
+{
+	/* Stretched to the slot, still once per slot */
+	static const int64_t period_s[] = {3, 10};
+	struct app_sched_task tasks[ARRAY_SIZE(period_s)];
+	int64_t next_ms;
+	uint32_t due;
+
+	tasks_init(tasks, ARRAY_SIZE(tasks), period_s, NULL);
+
+	due = app_sched_due(tasks, ARRAY_SIZE(tasks), SLOT_MS, 0, &next_ms);
+	zassert_equal(due, 0);
+	zassert_equal(next_ms, SLOT_MS);
+
+	due = app_sched_due(tasks, ARRAY_SIZE(tasks), SLOT_MS, SLOT_MS, &next_ms);
+	zassert_equal(due, BIT(0) | BIT(1));
+	zassert_equal(next_ms, 2 * SLOT_MS);
+}
+
+ZTEST(sched, test_phase_spreads_equal_periods)
+{
+	static const int64_t period_s[] = {60, 60, 60};
+	static const int64_t phase_s[] = {0, 20, 40};
+	struct app_sched_task tasks[ARRAY_SIZE(period_s)];
+	struct run_log log;
+
+	tasks_init(tasks, ARRAY_SIZE(tasks), period_s, phase_s);
+	simulate(tasks, ARRAY_SIZE(tasks), DAY_MS, LATE_MAX_MS, &log);
+
+	/* One wake-up per read, and each task still once a minute */
+	zassert_equal(log.wakeups, log.runs[0] + log.runs[1] + log.runs[2]);
+	for (size_t i = 0; i < ARRAY_SIZE(period_s); i++) {
+		zassert_within(log.runs[i], 1440, 1);
+	}
+}
+
+ZTEST(sched, test_phase_within_slot)
+{
+	/* Both due inside the same slot: read together at its end */
+	static const int64_t period_s[] = {60, 60};
+	static const int64_t phase_s[] = {2, 7};
+	struct app_sched_task tasks[ARRAY_SIZE(period_s)];
+	struct run_log log;
+
+	tasks_init(tasks, ARRAY_SIZE(tasks), period_s, phase_s);
+	simulate(tasks, ARRAY_SIZE(tasks), DAY_MS, 0, &log);
+
+	zassert_equal(log.wakeups, log.runs[0]);
+	zassert_equal(log.runs[0], log.runs[1]);
+}
+
+ZTEST(sched, test_phase_at_boot)
+{
+	static const int64_t period_s[] = {60, 60};
+	static const int64_t phase_s[] = {30, 90};
+	struct app_sched_task tasks[ARRAY_SIZE(period_s)];
+	int64_t next_ms;
+
+	/* The first period starts at the phase, not one period later */
+	tasks_init(tasks, ARRAY_SIZE(tasks), period_s, phase_s);
+	zassert_equal(app_sched_due(tasks, ARRAY_SIZE(tasks), SLOT_MS, 0, &next_ms), 0);
+	zassert_equal(next_ms, 30 * MSEC_PER_SEC);
+
+	/* Phases are taken modulo the period */
+	zassert_equal(tasks[1].phase_ms, 30 * MSEC_PER_SEC);
+	zassert_equal(app_sched_due(tasks, ARRAY_SIZE(tasks), SLOT_MS, next_ms, &next_ms),
+		      BIT(0) | BIT(1));
+	zassert_equal(next_ms, 90 * MSEC_PER_SEC);
+}
+
+ZTEST(sched, test_late_wakeup_skips_missed_periods)
+{
+	static const int64_t period_s[] = {60};
+	struct app_sched_task tasks[ARRAY_SIZE(period_s)];
+	int64_t next_ms;
+
+	tasks_init(tasks, ARRAY_SIZE(tasks), period_s, NULL);
+
+	/* Three and a half periods late: one run, then back on the grid */
+	zassert_equal(app_sched_due(tasks, 1, SLOT_MS, 210 * MSEC_PER_SEC, &next_ms), BIT(0));
+	zassert_equal(next_ms, 240 * MSEC_PER_SEC);
+	zassert_equal(app_sched_due(tasks, 1, SLOT_MS, 211 * MSEC_PER_SEC, &next_ms), 0);
+}
+
+ZTEST(sched, test_set_period)
+{
+	struct app_sched_task task = {0};
+	int64_t next_ms;
+
+	app_sched_task_set_period(&task, 60 * MSEC_PER_SEC, 0, 0);
+
+	/* Unchanged settings keep the grid */
+	app_sched_task_set_period(&task, 60 * MSEC_PER_SEC, 0, 50 * MSEC_PER_SEC);
+	zassert_equal(app_sched_due(&task, 1, SLOT_MS, 50 * MSEC_PER_SEC, &next_ms), 0);
+	zassert_equal(next_ms, 60 * MSEC_PER_SEC);
+
+	/* A new period starts at its next multiple */
+	app_sched_task_set_period(&task, 300 * MSEC_PER_SEC, 0, 50 * MSEC_PER_SEC);
+	zassert_equal(app_sched_due(&task, 1, SLOT_MS, 50 * MSEC_PER_SEC, &next_ms), 0);
+	zassert_equal(next_ms, 300 * MSEC_PER_SEC);
+
+	/* So does a new phase */
+	app_sched_task_set_period(&task, 300 * MSEC_PER_SEC, 100 * MSEC_PER_SEC,
+				  150 * MSEC_PER_SEC);
+	zassert_equal(app_sched_due(&task, 1, SLOT_MS, 150 * MSEC_PER_SEC, &next_ms), 0);
+	zassert_equal(next_ms, 400 * MSEC_PER_SEC);
+}
+
+ZTEST_SUITE(sched, NULL, NULL, NULL, NULL, NULL);
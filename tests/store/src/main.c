@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/ztest.h>
+
+#include "app_store.h"
+
+#define STORE_PARTITION_ID FIXED_PARTITION_ID(sample_storage)
+#define STORE_PARTITION_SIZE FIXED_PARTITION_SIZE(sample_storage)
+
+#define DRAIN_BATCH 16
+
+static struct app_sample batch[DRAIN_BATCH];
+
+static void append_range(int64_t first, int64_t count)
+{
+	struct app_sample sample = {0};
+
+	for (int64_t i = first; i < first + count; i++) {
+		sample.uptime_ms = i;
+		sample.ts_ms = 1700000000000LL + i;
+		zassert_ok(app_store_append(&sample), "Append %lld failed", i);
+	}
+}
+
+/* Upload everything in batches; return the count and the first and last uptime */
+static size_t drain(int64_t *first, int64_t *last)
+{
+	size_t total = 0;
+	int count;
+
+	while (!app_store_is_empty()) {
+		count = app_store_peek(batch, ARRAY_SIZE(batch));
+		zassert_true(count > 0, "Peek returned %d", count);
+
+		for (int i = 0; i < count; i++) {
+			if (total == 0) {
+				*first = batch[i].uptime_ms;
+			} else {
+				/* Oldest first and nothing missing in between */
+				zassert_equal(batch[i].uptime_ms, *last + 1);
+			}
+			zassert_equal(batch[i].ts_ms, 1700000000000LL + batch[i].uptime_ms);
+
+			*last = batch[i].uptime_ms;
+			total++;
+		}
+
+		app_store_consume();
+	}
+
+	return total;
+}
+
+static void store_before(void *fixture)
+{
+	const struct flash_area *fa;
+
+	zassert_ok(flash_area_open(STORE_PARTITION_ID, &fa));
+	zassert_ok(flash_area_erase(fa, 0, fa->fa_size));
+	flash_area_close(fa);
+
+	zassert_ok(app_store_init());
+}
+
+ZTEST(store, test_empty)
+{
+	zassert_true(app_store_is_empty());
+	zassert_equal(app_store_peek(batch, ARRAY_SIZE(batch)), 0);
+}
+
+ZTEST(store, test_append_offline_and_reboot)
+{
+	int64_t first;
+	int64_t last;
+
+	append_range(0, 10);
+	zassert_false(app_store_is_empty());
+
+	/* Samples survive a reboot */
+	zassert_ok(app_store_init());
+	zassert_false(app_store_is_empty());
+
+	zassert_equal(drain(&first, &last), 10);
+	zassert_equal(first, 0);
+	zassert_equal(last, 9);
+	zassert_true(app_store_is_empty());
+}
+
+ZTEST(store, test_batch_drain)
+{
+	int count;
+
+	append_range(0, 10);
+
+	/* Peeking again without consuming returns the same samples */
+	zassert_equal(app_store_peek(batch, 4), 4);
+	zassert_equal(app_store_peek(batch, 4), 4);
+	zassert_equal(batch[0].uptime_ms, 0);
+
+	app_store_consume();
+	zassert_equal(app_store_peek(batch, 4), 4);
+	zassert_equal(batch[0].uptime_ms, 4);
+	zassert_equal(batch[3].uptime_ms, 7);
+
+	app_store_consume();
+	count = app_store_peek(batch, 4);
+	zassert_equal(count, 2);
+	zassert_equal(batch[0].uptime_ms, 8);
+	zassert_equal(batch[1].uptime_ms, 9);
+
+	app_store_consume();
+	zassert_true(app_store_is_empty());
+
+	/* Appending after a full drain starts a new queue */
+	append_range(10, 3);
+	zassert_equal(app_store_peek(batch, ARRAY_SIZE(batch)), 3);
+	zassert_equal(batch[0].uptime_ms, 10);
+}
+
+ZTEST(store, test_wrap_and_size_bound)
+{
+	size_t max = STORE_PARTITION_SIZE / sizeof(struct app_sample);
+	int64_t appended = 4 * max;
+	int64_t first;
+	int64_t last;
+	size_t kept;
+
+	/* Several times the partition: the oldest sectors are rotated out */
+	append_range(0, appended);
+
+	kept = drain(&first, &last);
+
+	zassert_true(kept <= max, "%zu samples kept in %zu bytes", kept, STORE_PARTITION_SIZE);
+	/* All but the sector being erased hold samples */
+	zassert_true(kept >= max / 2, "Only %zu of %zu samples kept", kept, max);
+	zassert_equal(last, appended - 1, "Newest sample lost");
+	zassert_equal(first, appended - kept);
+}
+
+ZTEST(store, test_rotation_while_draining)
+{
+	size_t max = STORE_PARTITION_SIZE / sizeof(struct app_sample);
+	int64_t first;
+	int64_t last;
+
+	append_range(0, max / 2);
+
+	/* Part of the queue is uploaded, then the link goes down again */
+	zassert_equal(app_store_peek(batch, ARRAY_SIZE(batch)), ARRAY_SIZE(batch));
+	app_store_consume();
+
+	append_range(max / 2, 2 * max);
+
+	drain(&first, &last);
+	zassert_equal(last, max / 2 + 2 * max - 1);
+	zassert_true(first > ARRAY_SIZE(batch));
+}
+
+ZTEST_SUITE(store, NULL, NULL, store_before, NULL, NULL);
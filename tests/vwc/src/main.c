@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+
+#include "app_moisture.h"
+#include "app_vwc.h"
+
+#define RAW_Q(_raw) ((int32_t)(_raw) << VWC_RAW_FRAC_BITS)
+
+/* Example curve of the README: drier soil reads higher */
+#define README_CURVE "3400:0, 2900:12.5, 2300:41"
+
+/* Linear curve of a capacitive probe, 0 % in air to 50 % in saturated soil */
+#define LINEAR_CURVE "3500:0,1500:50"
+
+static int parse(struct vwc_curve *curve, const char *str)
+{
+	return vwc_curve_parse(curve, str, strlen(str));
+}
+
+ZTEST(vwc, test_parse_reference)
+{
+	struct vwc_curve curve;
+
+	zassert_ok(parse(&curve, README_CURVE));
+	zassert_equal(curve.count, 3);
+
+	/* Sorted by ascending reading, VWC in milli-percent */
+	zassert_equal(curve.points[0].raw, 2300);
+	zassert_equal(curve.points[0].vwc, 41000);
+	zassert_equal(curve.points[1].raw, 2900);
+	zassert_equal(curve.points[1].vwc, 12500);
+	zassert_equal(curve.points[2].raw, 3400);
+	zassert_equal(curve.points[2].vwc, 0);
+	zassert_ok(vwc_curve_check(&curve));
+
+	/* Spacing does not matter */
+	zassert_ok(parse(&curve, " 3400 : 0 ,\t2900: 12.5 , 2300 :41.000 "));
+	zassert_equal(curve.points[1].vwc, 12500);
+	zassert_equal(curve.points[0].vwc, 41000);
+
+	zassert_ok(parse(&curve, ""));
+	zassert_equal(curve.count, 0);
+}
+
+ZTEST(vwc, test_parse_errors)
+{
+	static const char *const bad[] = {
+		"3400",                 /* no VWC */
+		"3400:0",               /* single point */
+		"3400:0,3400:5",        /* duplicate reading */
+		"3400:0,",              /* trailing separator */
+		"3400:0;2900:12",       /* wrong separator */
+		"4096:0,2900:12",       /* reading above the ADC range */
+		"-1:0,2900:12",         /* negative reading */
+		"3400:100.001,2900:12", /* VWC above 100 % */
+		"3400:1.2345,2900:12",  /* more than three decimals */
+		"3400:5.,2900:12",      /* no digit after the point */
+		"3400.5:0,2900:12",     /* fractional reading */
+	};
+	struct vwc_curve curve;
+
+	zassert_ok(parse(&curve, LINEAR_CURVE));
+
+	for (size_t i = 0; i < ARRAY_SIZE(bad); i++) {
+		zassert_equal(parse(&curve, bad[i]), -EINVAL, "Accepted \"%s\"", bad[i]);
+	}
+
+	/* Left untouched on failure */
+	zassert_equal(curve.count, 2);
+	zassert_equal(curve.points[0].raw, 1500);
+}
+
+ZTEST(vwc, test_parse_too_many_points)
+{
+	char str[16 * (CONFIG_APP_VWC_POINTS_MAX + 1)];
+	struct vwc_curve curve;
+	size_t len = 0;
+
+	for (int i = 0; i <= CONFIG_APP_VWC_POINTS_MAX; i++) {
+		len += snprintf(&str[len], sizeof(str) - len, "%s%d:%d", i ? "," : "", 100 * i, i);
+	}
+
+	zassert_equal(vwc_curve_parse(&curve, str, len), -E2BIG);
+
+	/* One point less fits */
+	len = strrchr(str, ',') - str;
+	zassert_ok(vwc_curve_parse(&curve, str, len));
+	zassert_equal(curve.count, CONFIG_APP_VWC_POINTS_MAX);
+}
+
+ZTEST(vwc, test_check_restored)
+{
+	struct vwc_curve curve;
+
+	zassert_ok(parse(&curve, README_CURVE));
+
+	/* A curve restored from flash must still be sorted and in range */
+	curve.points[2].raw = curve.points[1].raw;
+	zassert_equal(vwc_curve_check(&curve), -EINVAL);
+
+	zassert_ok(parse(&curve, README_CURVE));
+	curve.points[0].vwc = VWC_MAX + 1;
+	zassert_equal(vwc_curve_check(&curve), -EINVAL);
+
+	zassert_ok(parse(&curve, README_CURVE));
+	curve.count = 1;
+	zassert_equal(vwc_curve_check(&curve), -EINVAL);
+}
+
+ZTEST(vwc, test_eval_reference)
+{
+	struct vwc_curve curve;
+
+	zassert_ok(parse(&curve, README_CURVE));
+
+	/* The points themselves */
+	zassert_equal(vwc_eval(&curve, RAW_Q(2300)), 41000);
+	zassert_equal(vwc_eval(&curve, RAW_Q(2900)), 12500);
+	zassert_equal(vwc_eval(&curve, RAW_Q(3400)), 0);
+
+	/* Interpolated on both segments */
+	zassert_equal(vwc_eval(&curve, RAW_Q(2600)), 26750);
+	zassert_equal(vwc_eval(&curve, RAW_Q(2500)), 31500);
+	zassert_equal(vwc_eval(&curve, RAW_Q(3150)), 6250);
+
+	/* Fractional readings, rounded to the nearest milli-percent */
+	zassert_equal(vwc_eval(&curve, RAW_Q(2600) + (1 << (VWC_RAW_FRAC_BITS - 1))), 26726);
+
+	/* Outside the curve, the nearest end */
+	zassert_equal(vwc_eval(&curve, 0), 41000);
+	zassert_equal(vwc_eval(&curve, RAW_Q(2299)), 41000);
+	zassert_equal(vwc_eval(&curve, RAW_Q(3401)), 0);
+	zassert_equal(vwc_eval(&curve, RAW_Q(MOISTURE_ADC_MAX)), 0);
+}
+
+ZTEST(vwc, test_eval_linear)
+{
+	struct vwc_curve curve;
+	int32_t prev = VWC_MAX;
+
+	zassert_ok(parse(&curve, LINEAR_CURVE));
+
+	/* 40 counts per percent */
+	zassert_equal(vwc_eval(&curve, RAW_Q(2500)), 25000);
+	zassert_equal(vwc_eval(&curve, RAW_Q(1540)), 49000);
+	zassert_equal(vwc_eval(&curve, RAW_Q(3499)), 25);
+
+	/* Monotonic over the whole ADC range */
+	for (int32_t raw = 0; raw <= MOISTURE_ADC_MAX; raw++) {
+		int32_t vwc = vwc_eval(&curve, RAW_Q(raw));
+
+		zassert_true(vwc <= prev, "VWC rises at %d", raw);
+		prev = vwc;
+	}
+}
+
+ZTEST(vwc, test_temp_compensate)
+{
+	/* At the reference temperature the reading is unchanged */
+	zassert_equal(vwc_temp_compensate(3000, 25000, 2000, 25), RAW_Q(3000));
+
+	/* 2 counts/°C, 10 °C above and below the reference */
+	zassert_equal(vwc_temp_compensate(3000, 35000, 2000, 25), RAW_Q(2980));
+	zassert_equal(vwc_temp_compensate(3000, 15000, 2000, 25), RAW_Q(3020));
+
+	/* Negative coefficients move the other way */
+	zassert_equal(vwc_temp_compensate(3000, 35000, -2000, 25), RAW_Q(3020));
+
+	/* Fractions of a count are kept */
+	zassert_equal(vwc_temp_compensate(3000, 26000, 1500, 25),
+		      RAW_Q(3000) - (3 << (VWC_RAW_FRAC_BITS - 1)));
+
+	/* Clamped to the ADC range */
+	zassert_equal(vwc_temp_compensate(10, 45000, 100000, 25), 0);
+	zassert_equal(vwc_temp_compensate(4090, -15000, 100000, 25), RAW_Q(MOISTURE_ADC_MAX));
+}
+
+ZTEST(vwc, test_compensated_reference)
+{
+	struct vwc_curve curve;
+	int32_t raw_q;
+
+	zassert_ok(parse(&curve, LINEAR_CURVE));
+
+	/* 2540 counts at 45 °C read as 2500 at 25 °C, i.e. 25 % */
+	raw_q = vwc_temp_compensate(2540, 45000, 2000, 25);
+	zassert_equal(vwc_eval(&curve, raw_q), 25000);
+}
+
+ZTEST_SUITE(vwc, NULL, NULL, NULL, NULL, NULL);